@@ -0,0 +1,103 @@
+/*
+ * attackmap.cc
+ * This file is part of chess, a console chess engine.
+ * Copyright (C) 2023 Cyprien Lacassagne
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "attackmap.h"
+
+namespace {
+    Bitboard sliders(const Position& pos) {
+        return pos.pieces(BISHOP) | pos.pieces(ROOK) | pos.pieces(QUEEN);
+    }
+
+    Bitboard compute_slider_attacks(const Position& pos, int sq) {
+        Bitboard b(square_bb(sq));
+        Bitboard attacks(0);
+        if (b & (pos.pieces(BISHOP) | pos.pieces(QUEEN)))
+            attacks |= bitboard::bishop_attacks(sq, pos.pieces());
+        if (b & (pos.pieces(ROOK) | pos.pieces(QUEEN)))
+            attacks |= bitboard::rook_attacks(sq, pos.pieces());
+        return attacks;
+    }
+
+    Bitboard pawns_attacks(Color c, Bitboard pawns) {
+        return c == WHITE ? ((pawns & ~file_a_bb) << 7) | ((pawns & ~file_h_bb) << 9)
+                          : ((pawns & ~file_a_bb) >> 9) | ((pawns & ~file_h_bb) >> 7);
+    }
+}
+
+void AttackMap::init(const Position& pos) {
+    for (int sq(0); sq < nb_squares; ++sq)
+        by_square[sq] = compute_slider_attacks(pos, sq);
+    updt_color_attacks(pos);
+}
+
+int AttackMap::update(const Position& pos, PackedMove move, const Position& next,
+                      Undo& undo) {
+    undo.by_color[WHITE] = by_color[WHITE];
+    undo.by_color[BLACK] = by_color[BLACK];
+    undo.n_changes = 0;
+
+    // Squares whose content changed: start and target squares, the square of
+    // a pawn captured en passant and the squares of a castling rook.
+    Bitboard touched((pos.pieces() ^ next.pieces())
+                     | square_bb(move.from()) | square_bb(move.to()));
+    int n_updts(0);
+    for (Bitboard b(touched & (sliders(pos) | sliders(next))); b; ) {
+        int sq(pop_lsb(b));
+        Bitboard attacks(compute_slider_attacks(next, sq));
+        n_updts += (attacks != 0);
+        set(sq, attacks, undo);
+    }
+
+    // Sliders left in place, whose rays were blocked or unblocked
+    for (Bitboard b(sliders(next) & ~touched); b; ) {
+        int sq(pop_lsb(b));
+        if (by_square[sq] & touched) {
+            set(sq, compute_slider_attacks(next, sq), undo);
+            ++n_updts;
+        }
+    }
+
+    updt_color_attacks(next);
+    return n_updts;
+}
+
+void AttackMap::restore(const Undo& undo) {
+    for (int i(undo.n_changes - 1); i >= 0; --i)
+        by_square[undo.squares[i]] = undo.attacks[i];
+    by_color[WHITE] = undo.by_color[WHITE];
+    by_color[BLACK] = undo.by_color[BLACK];
+}
+
+void AttackMap::set(int sq, Bitboard attacks, Undo& undo) {
+    undo.squares[undo.n_changes] = sq;
+    undo.attacks[undo.n_changes] = by_square[sq];
+    ++undo.n_changes;
+    by_square[sq] = attacks;
+}
+
+void AttackMap::updt_color_attacks(const Position& pos) {
+    for (Color c : {WHITE, BLACK}) {
+        by_color[c] = pawns_attacks(c, pos.pieces(c, PAWN))
+                    | bitboard::king_attacks(pos.king_square(c));
+        for (Bitboard b(pos.pieces(c, KNIGHT)); b; )
+            by_color[c] |= bitboard::knight_attacks(pop_lsb(b));
+        for (Bitboard b(pos.pieces(c) & sliders(pos)); b; )
+            by_color[c] |= by_square[pop_lsb(b)];
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef ATTACKMAP_H
+#define ATTACKMAP_H
+
+#include "bitboard.h"
+#include "position.h"
+#include "move.h"
+
+/*
+ * Squares attacked by each side. Leaper attacks are cheap to get from the
+ * tables, but the attacks of every slider are kept from one position to the
+ * next: a move only changes the attacks of the sliders it moves, and of those
+ * whose rays cross one of the squares it empties or fills.
+ *
+ * The map is updated in place when a move is played and restored from an
+ * Undo record when it is taken back.
+ */
+class AttackMap {
+    // Up to four squares change, and any slider of the board can be hit.
+    static constexpr int max_changes = 4 + 2 * 14;
+
+public:
+    struct Undo {
+        Bitboard by_color[2];
+        int n_changes;
+        int squares[max_changes];
+        Bitboard attacks[max_changes];
+    };
+
+    /* Compute the attacks of every slider from scratch */
+    void init(const Position& pos);
+
+    /**
+     * @param pos The position before the move, which this map describes.
+     * @param move The move played.
+     * @param next The position after the move.
+     * @param undo Filled with what is needed to restore the map.
+     * @return The number of sliders whose attacks were recomputed.
+     */
+    int update(const Position& pos, PackedMove move, const Position& next, Undo& undo);
+    void restore(const Undo& undo);
+
+    /**
+     * @param sq The square's index.
+     * @return The squares attacked by the slider on the square, friendly ones
+     *         included, or an empty set if there is no slider on it.
+     */
+    Bitboard slider_attacks(int sq) const { return by_square[sq]; }
+    Bitboard attacks(Color c) const { return by_color[c]; }
+
+private:
+    Bitboard by_square[nb_squares];
+    Bitboard by_color[2];
+
+    void set(int sq, Bitboard attacks, Undo& undo);
+    void updt_color_attacks(const Position& pos);
+};
+
+#endif
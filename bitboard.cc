@@ -0,0 +1,270 @@
+/*
+ * bitboard.cc
+ * This file is part of chess, a console chess engine.
+ * Copyright (C) 2023 Cyprien Lacassagne
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "bitboard.h"
+
+namespace {
+    // Steps on the board, expressed as (file, rank) offsets.
+    struct Step {
+        int file;
+        int rank;
+    };
+
+    constexpr Step rook_steps[4] = {{1, 0}, {-1, 0}, {0, 1}, {0, -1}};
+    constexpr Step bishop_steps[4] = {{1, 1}, {-1, 1}, {1, -1}, {-1, -1}};
+    bool on_board(int file, int rank) {
+        return file >= 0 && file < board_size && rank >= 0 && rank < board_size;
+    }
+
+    // Walk each ray until the edge of the board or the first blocker (included).
+    // Only used to build and verify the sliding attack tables.
+    Bitboard slider_attacks(const Step* steps, int sq, Bitboard occupied) {
+        Bitboard attacks(0);
+        for (int i(0); i < 4; ++i) {
+            int f(sq % board_size + steps[i].file);
+            int r(sq / board_size + steps[i].rank);
+            while (on_board(f, r)) {
+                Bitboard b(square_bb(r * board_size + f));
+                attacks |= b;
+                if (b & occupied)
+                    break;
+                f += steps[i].file;
+                r += steps[i].rank;
+            }
+        }
+        return attacks;
+    }
+
+    // Number of entries over all squares: sum of 2^(relevant squares).
+    constexpr int rook_table_size(0x19000);
+    constexpr int bishop_table_size(0x1480);
+
+    Bitboard rook_table[rook_table_size];
+    Bitboard bishop_table[bishop_table_size];
+
+    // xorshift64* generator, seeded so that the magics found are reproducible.
+    class Prng {
+    public:
+        explicit Prng(uint64_t seed) : s(seed) {}
+        uint64_t rand() {
+            s ^= s >> 12;
+            s ^= s << 25;
+            s ^= s >> 27;
+            return s * 2685821657736338717ULL;
+        }
+        uint64_t sparse_rand() { return rand() & rand() & rand(); }
+    private:
+        uint64_t s;
+    };
+
+    // One seed per rank, picked so that the search below ends quickly.
+    constexpr uint64_t magic_seeds[board_size] = {728, 10316, 55013, 32803,
+                                                  12281, 15100, 16645, 255};
+
+    void init_magics(const Step* steps, Bitboard* table, Magic* magics) {
+        Bitboard reference[4096];
+#ifndef USE_PEXT
+        Bitboard occupancy[4096];
+        int epoch[4096] = {0};
+        int attempt(0);
+#endif
+
+        for (int sq(0); sq < nb_squares; ++sq) {
+            // The edges never block a ray, unless the piece stands on them.
+            Bitboard edges(((rank_1_bb | rank_8_bb) & ~(rank_1_bb << 8 * (sq / 8)))
+                           | ((file_a_bb | file_h_bb) & ~(file_a_bb << sq % 8)));
+            Magic& m(magics[sq]);
+            m.mask = slider_attacks(steps, sq, 0) & ~edges;
+            m.shift = 64 - popcount(m.mask);
+            m.attacks = (sq == 0 ? table
+                         : magics[sq-1].attacks + (1 << (64 - magics[sq-1].shift)));
+
+            // Enumerate every subset of the mask (Carry-Rippler trick).
+            int size(0);
+            Bitboard b(0);
+            do {
+                reference[size] = slider_attacks(steps, sq, b);
+#ifdef USE_PEXT
+                m.attacks[m.index(b)] = reference[size];
+#else
+                occupancy[size] = b;
+#endif
+                ++size;
+                b = (b - m.mask) & m.mask;
+            } while (b);
+
+#ifndef USE_PEXT
+            // Try random sparse candidates until one maps every subset without
+            // a destructive collision.
+            Prng prng(magic_seeds[sq / board_size]);
+            for (int i(0); i < size; ) {
+                for (m.magic = 0; popcount((m.magic * m.mask) >> 56) < 6; )
+                    m.magic = prng.sparse_rand();
+
+                ++attempt;
+                for (i = 0; i < size; ++i) {
+                    unsigned idx(m.index(occupancy[i]));
+                    if (epoch[idx] < attempt) {
+                        epoch[idx] = attempt;
+                        m.attacks[idx] = reference[i];
+                    }else if (m.attacks[idx] != reference[i])
+                        break;
+                }
+            }
+#endif
+        }
+    }
+
+    void init_lines() {
+        for (int s1(0); s1 < nb_squares; ++s1) {
+            for (int s2(0); s2 < nb_squares; ++s2) {
+                if (s1 == s2)
+                    continue;
+                for (PieceType pt : {BISHOP, ROOK}) {
+                    if (!(bitboard::attacks(pt, s1, 0) & square_bb(s2)))
+                        continue;
+                    bitboard::line_table[s1][s2] = (bitboard::attacks(pt, s1, 0)
+                                                    & bitboard::attacks(pt, s2, 0))
+                                                   | square_bb(s1) | square_bb(s2);
+                    bitboard::between_table[s1][s2] = bitboard::attacks(pt, s1, square_bb(s2))
+                                                      & bitboard::attacks(pt, s2, square_bb(s1));
+                }
+            }
+        }
+    }
+
+    /*
+     * Reference walkers for the self-check, kept apart from the one building
+     * the tables so that a mistake in it can't hide: like the rook_range() and
+     * bishop_range() of the pieces, they walk files and ranks, one loop per
+     * direction, and stop on the first occupied square (included).
+     */
+    bool blocks(Bitboard occupied, char file, int rank, Bitboard& attacks) {
+        attacks |= square_bb(file, rank);
+        return occupied & square_bb(file, rank);
+    }
+
+    Bitboard rook_reference(int sq, Bitboard occupied) {
+        char file(square_file(sq));
+        int rank(square_rank(sq));
+        Bitboard attacks(0);
+        for (char c(file+1); c <= 'h' && !blocks(occupied, c, rank, attacks); ++c) {}
+        for (char c(file-1); c >= 'a' && !blocks(occupied, c, rank, attacks); --c) {}
+        for (int r(rank+1); r <= board_size && !blocks(occupied, file, r, attacks); ++r) {}
+        for (int r(rank-1); r >= 1 && !blocks(occupied, file, r, attacks); --r) {}
+        return attacks;
+    }
+
+    Bitboard bishop_reference(int sq, Bitboard occupied) {
+        char file(square_file(sq));
+        int rank(square_rank(sq));
+        Bitboard attacks(0);
+        for (int i(1); file+i <= 'h' && rank+i <= board_size
+                       && !blocks(occupied, char(file+i), rank+i, attacks); ++i) {}
+        for (int i(1); file-i >= 'a' && rank+i <= board_size
+                       && !blocks(occupied, char(file-i), rank+i, attacks); ++i) {}
+        for (int i(1); file+i <= 'h' && rank-i >= 1
+                       && !blocks(occupied, char(file+i), rank-i, attacks); ++i) {}
+        for (int i(1); file-i >= 'a' && rank-i >= 1
+                       && !blocks(occupied, char(file-i), rank-i, attacks); ++i) {}
+        return attacks;
+    }
+
+    bool verify_magics(Bitboard (*reference)(int, Bitboard), const Magic* magics) {
+        for (int sq(0); sq < nb_squares; ++sq) {
+            const Magic& m(magics[sq]);
+            Bitboard b(0);
+            do {
+                // Squares outside the mask must not change the result.
+                Bitboard occupied(b | ~(m.mask | square_bb(sq)));
+                if (m.attacks[m.index(b)] != reference(sq, b)
+                    || m.attacks[m.index(occupied)] != reference(sq, occupied))
+                    return false;
+                b = (b - m.mask) & m.mask;
+            } while (b);
+        }
+        return true;
+    }
+
+    // Attack sets worked out by hand, in case the walkers share a mistake
+    struct Sample {
+        PieceType pt;
+        int sq;
+        Bitboard occupied;
+        Bitboard attacks;
+    };
+
+    constexpr Sample samples[] = {
+        {ROOK, 0, 0, 0x01010101010101FEULL},                        // a1, empty board
+        {BISHOP, 27, 0, 0x8041221400142241ULL},                     // d4, empty board
+        {ROOK, 28, 0x0000100082001000ULL, 0x00001010EE101000ULL},   // e4, e2 e6 b4 h4
+        {BISHOP, 2, 0x0A00ULL, 0x0A00ULL},                          // c1, b2 d2
+        {ROOK, 63, 0x4080000000000000ULL, 0x4080000000000000ULL},   // h8, g8 h7
+        {BISHOP, 54, 0xA000801000000000ULL, 0xA000A01000000000ULL}  // g7, e5 f8 h8 h6
+    };
+}
+
+Magic bitboard::rook_magics[nb_squares];
+Magic bitboard::bishop_magics[nb_squares];
+Bitboard bitboard::between_table[nb_squares][nb_squares];
+Bitboard bitboard::line_table[nb_squares][nb_squares];
+
+void bitboard::init() {
+    init_magics(rook_steps, rook_table, rook_magics);
+    init_magics(bishop_steps, bishop_table, bishop_magics);
+    // Lines are derived from the sliding attacks, so they come last.
+    init_lines();
+}
+
+bool bitboard::verify_slider_tables() {
+    for (const Sample& s : samples) {
+        if (attacks(s.pt, s.sq, s.occupied) != s.attacks)
+            return false;
+    }
+    return verify_magics(rook_reference, rook_magics)
+        && verify_magics(bishop_reference, bishop_magics);
+}
+
+PieceType code_type(char code) {
+    switch (code) {
+        case 'P': case 'p': return PAWN;
+        case 'N': case 'n': return KNIGHT;
+        case 'B': case 'b': return BISHOP;
+        case 'R': case 'r': return ROOK;
+        case 'Q': case 'q': return QUEEN;
+        case 'K': case 'k': return KING;
+        default: return NO_PIECE_TYPE;
+    }
+}
+
+char piece_code(Color c, PieceType pt) {
+    static const char codes[] = "PNBRQK";
+    return (c == WHITE ? codes[pt] : char(codes[pt] - upcase_shift));
+}
+
+Bitboard bitboard::attacks(PieceType pt, int sq, Bitboard occupied) {
+    switch (pt) {
+        case KNIGHT: return attacks<KNIGHT>(sq, occupied);
+        case BISHOP: return attacks<BISHOP>(sq, occupied);
+        case ROOK: return attacks<ROOK>(sq, occupied);
+        case QUEEN: return attacks<QUEEN>(sq, occupied);
+        case KING: return attacks<KING>(sq, occupied);
+        default: return 0;
+    }
+}
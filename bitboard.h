@@ -0,0 +1,209 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#include <cstdint>
+#include <array>
+#ifdef USE_PEXT
+    #include <immintrin.h>
+#endif
+#include "common.h"
+
+/*
+ * A bitboard is a set of squares packed in a 64-bit word.
+ * Bit 0 is a1, bit 7 is h1, bit 63 is h8.
+ */
+typedef uint64_t Bitboard;
+
+enum Color { WHITE, BLACK };
+enum PieceType { PAWN, KNIGHT, BISHOP, ROOK, QUEEN, KING, NO_PIECE_TYPE };
+
+constexpr int nb_squares(64);
+constexpr int nb_piece_types(6);
+constexpr int no_square(-1);
+
+constexpr Bitboard file_a_bb(0x0101010101010101ULL);
+constexpr Bitboard file_h_bb(file_a_bb << 7);
+constexpr Bitboard rank_1_bb(0xFFULL);
+constexpr Bitboard rank_8_bb(rank_1_bb << 56);
+
+constexpr Bitboard rank_bb(int rank) { return rank_1_bb << board_size * (rank - 1); }
+
+constexpr Color operator!(Color c) { return Color(c ^ BLACK); }
+
+inline int square_index(char file, int rank) {
+    return (rank - 1) * board_size + (file - 'a');
+}
+inline char square_file(int sq) { return char('a' + sq % board_size); }
+inline int square_rank(int sq) { return sq / board_size + 1; }
+inline Square to_square(int sq) { return {square_file(sq), square_rank(sq)}; }
+
+constexpr Bitboard square_bb(int sq) { return Bitboard(1) << sq; }
+inline Bitboard square_bb(char file, int rank) { return square_bb(square_index(file, rank)); }
+
+/* The step of a pawn push of the given side, in squares */
+constexpr int pawn_push(Color c) { return (c == WHITE ? board_size : -board_size); }
+
+/**
+ * @tparam Step A king step, or a double pawn push.
+ * @return The squares moved by the step, those leaving the board dropped.
+ */
+template<int Step>
+constexpr Bitboard shift(Bitboard b) {
+    static_assert(Step == 8 || Step == -8 || Step == 16 || Step == -16 || Step == 7
+                  || Step == 9 || Step == -7 || Step == -9, "Not a step");
+    if constexpr (Step == 9 || Step == -7)
+        b &= ~file_h_bb;
+    else if constexpr (Step == 7 || Step == -9)
+        b &= ~file_a_bb;
+    return (Step > 0 ? b << Step : b >> -Step);
+}
+
+inline int popcount(Bitboard b) { return __builtin_popcountll(b); }
+inline int lsb(Bitboard b) { return __builtin_ctzll(b); }
+inline int pop_lsb(Bitboard& b) {
+    int sq(lsb(b));
+    b &= b - 1;
+    return sq;
+}
+
+/* Piece codes keep the board convention: upper case for White, lower case for Black */
+inline Color code_color(char code) { return (code >= 'a' ? BLACK : WHITE); }
+PieceType code_type(char code);
+char piece_code(Color c, PieceType pt);
+
+/*
+ * Sliding attacks are looked up in precomputed tables. The relevant occupancy
+ * of the rays (edges excluded) is hashed to a table index, either with a magic
+ * multiplication or, when built with USE_PEXT, with the BMI2 pext instruction.
+ */
+struct Magic {
+    Bitboard mask;
+    Bitboard magic;
+    Bitboard* attacks;
+    unsigned shift;
+
+    unsigned index(Bitboard occupied) const {
+#ifdef USE_PEXT
+        return unsigned(_pext_u64(occupied, mask));
+#else
+        return unsigned(((occupied & mask) * magic) >> shift);
+#endif
+    }
+};
+
+/*
+ * Leaper attacks do not depend on the occupancy, so they are generated
+ * once and for all at compile time.
+ */
+namespace bitboard {
+    typedef std::array<Bitboard, nb_squares> Table;
+
+    /**
+     * @return The square reached from @p sq by the given step, or an empty set
+     *         if the step leaves the board.
+     */
+    constexpr Bitboard step_bb(int sq, int file_step, int rank_step) {
+        int f(sq % board_size + file_step);
+        int r(sq / board_size + rank_step);
+        return (f >= 0 && f < board_size && r >= 0 && r < board_size)
+               ? square_bb(r * board_size + f) : 0;
+    }
+
+    template<size_t N>
+    constexpr Table make_leaper_table(const int (&steps)[N][2]) {
+        Table table{};
+        for (int sq(0); sq < nb_squares; ++sq) {
+            for (size_t i(0); i < N; ++i)
+                table[sq] |= step_bb(sq, steps[i][0], steps[i][1]);
+        }
+        return table;
+    }
+
+    constexpr int knight_steps[8][2] = {{1, 2}, {2, 1}, {2, -1}, {1, -2},
+                                        {-1, -2}, {-2, -1}, {-2, 1}, {-1, 2}};
+    constexpr int king_steps[8][2] = {{1, 0}, {1, 1}, {0, 1}, {-1, 1},
+                                      {-1, 0}, {-1, -1}, {0, -1}, {1, -1}};
+    constexpr int w_pawn_captures[2][2] = {{-1, 1}, {1, 1}};
+    constexpr int b_pawn_captures[2][2] = {{-1, -1}, {1, -1}};
+    constexpr int w_pawn_push[1][2] = {{0, 1}};
+    constexpr int b_pawn_push[1][2] = {{0, -1}};
+
+    inline constexpr Table knight_table(make_leaper_table(knight_steps));
+    inline constexpr Table king_table(make_leaper_table(king_steps));
+    inline constexpr Table pawn_attack_table[2] = {make_leaper_table(w_pawn_captures),
+                                                   make_leaper_table(b_pawn_captures)};
+    // Single step forward. Pawns never stand on their last rank.
+    inline constexpr Table pawn_push_table[2] = {make_leaper_table(w_pawn_push),
+                                                 make_leaper_table(b_pawn_push)};
+}
+
+namespace bitboard {
+    extern Magic rook_magics[nb_squares];
+    extern Magic bishop_magics[nb_squares];
+
+    /* Build the attack and line tables. Must be called once before any lookup. */
+    void init();
+
+    /**
+     * Compare every entry of the sliding attack tables with reference ray
+     * walkers, apart from the one building the tables, and a few attack sets
+     * worked out by hand.
+     * @return <tt>true</tt> if the tables match.
+     */
+    bool verify_slider_tables();
+
+    extern Bitboard between_table[nb_squares][nb_squares];
+    extern Bitboard line_table[nb_squares][nb_squares];
+
+    /**
+     * @return The squares strictly between @p sq1 and @p sq2, or an empty set
+     *         if they are not on a common rank, file or diagonal.
+     */
+    inline Bitboard between(int sq1, int sq2) { return between_table[sq1][sq2]; }
+
+    /**
+     * @return The whole line going through @p sq1 and @p sq2, edge to edge, or
+     *         an empty set if they are not on a common rank, file or diagonal.
+     */
+    inline Bitboard line(int sq1, int sq2) { return line_table[sq1][sq2]; }
+
+    inline Bitboard pawn_attacks(Color c, int sq) { return pawn_attack_table[c][sq]; }
+    inline Bitboard pawn_pushes(Color c, int sq) { return pawn_push_table[c][sq]; }
+    inline Bitboard knight_attacks(int sq) { return knight_table[sq]; }
+    inline Bitboard king_attacks(int sq) { return king_table[sq]; }
+
+    inline Bitboard bishop_attacks(int sq, Bitboard occupied) {
+        const Magic& m(bishop_magics[sq]);
+        return m.attacks[m.index(occupied)];
+    }
+    inline Bitboard rook_attacks(int sq, Bitboard occupied) {
+        const Magic& m(rook_magics[sq]);
+        return m.attacks[m.index(occupied)];
+    }
+
+    /**
+     * @tparam Pt The type of the piece, which must not be a pawn.
+     * @param sq The square the piece stands on.
+     * @param occupied The squares blocking the sliding pieces.
+     * @return The squares attacked by the piece, friendly ones included.
+     */
+    template<PieceType Pt>
+    inline Bitboard attacks(int sq, Bitboard occupied) {
+        static_assert(Pt != PAWN, "Pawn attacks depend on the color");
+        if constexpr (Pt == KNIGHT)
+            return knight_attacks(sq);
+        else if constexpr (Pt == BISHOP)
+            return bishop_attacks(sq, occupied);
+        else if constexpr (Pt == ROOK)
+            return rook_attacks(sq, occupied);
+        else if constexpr (Pt == QUEEN)
+            return bishop_attacks(sq, occupied) | rook_attacks(sq, occupied);
+        else
+            return king_attacks(sq);
+    }
+
+    /* Same as above, for a type known at run time only */
+    Bitboard attacks(PieceType pt, int sq, Bitboard occupied);
+}
+
+#endif
@@ -19,141 +19,87 @@
 
 #include <iostream>
 #include <array>
+#include <cstdlib>
 #include "board.h"
-#include "view.h"
-
-static Chessboard chessboard = {
-    'R', 'N', 'B', 'K', 'Q', 'B', 'N', 'R', // 1
-    'P', 'P', 'P', 'P', 'P', 'P', 'P', 'P', // 2
-    '.', '.', '.', '.', '.', '.', '.', '.', // 3
-    '.', '.', '.', '.', '.', '.', '.', '.', // 4
-    '.', '.', '.', '.', '.', '.', '.', '.', // 5
-    '.', '.', '.', '.', '.', '.', '.', '.', // 6
-    'p', 'p', 'p', 'p', 'p', 'p', 'p', 'p', // 7
-    'r', 'n', 'b', 'k', 'q', 'b', 'n', 'r'  // 8
-//   h    g    f    e    d    c    b    a 
-};
-
-void print_ascii() {
-    for (auto rank : chessboard) {
-        for (auto sq : rank) {
-            std::wcout << sq;
-        }
-        std::wcout << "\n";
-    }
+#include "position.h"
+
+
+Bitboard Board::get_en_passant_sqrs() const {
+    int sq(position.ep_square());
+    return (sq == no_square ? 0 : square_bb(sq));
 }
 
-void write_piece(char code, char file, int rank) {
-    chessboard[rank-1][int('h')-int(file)] = code;
+Chessboard Board::to_chessboard() const {
+    Chessboard chessboard(position.to_chessboard());
+    int sq(position.ep_square());
+    if (sq != no_square)
+        chessboard[sq / board_size][board_size - 1 - sq % board_size] = en_passant_sqr;
+    return chessboard;
 }
 
-void empty_board() {
-    for (auto& rank : chessboard) {
-        for (auto& sq : rank) {
-            if (sq != en_passant_sqr)
-                sq = '.';
+void Board::print_ascii() const {
+    for (auto rank : to_chessboard()) {
+        for (auto sq : rank) {
+            std::wcout << sq;
         }
+        std::wcout << "\n";
     }
 }
 
-void write_en_passant_sqr(char file, int rank) {
-    chessboard[rank-1][int('h')-int(file)] = en_passant_sqr;
+void Board::write_piece(char code, char file, int rank) {
+    position.put_piece(code, square_index(file, rank));
 }
 
-void clear_en_passant_sqr(char file, int rank) {
-    chessboard[rank-1][int('h')-int(file)] = '.';
-}
-
-void clear_en_passant_sqr() {
-    for (auto& rank : chessboard) {
-        for (auto& sq : rank) {
-            if (sq == en_passant_sqr)
-                sq = '.';
-        }
-    }
+void Board::empty_board() {
+    Position empty;
+    empty.set_state(position.side_to_move(), position.ep_square(),
+                    position.castling_rights());
+    position = empty;
 }
 
-bool is_en_passant_sqr(char file, int rank) {
-    return (chessboard[rank-1][int('h')-int(file)] == en_passant_sqr);
+void Board::write_en_passant_sqr(char file, int rank) {
+    position.set_state(position.side_to_move(), square_index(file, rank),
+                       position.castling_rights());
 }
 
-bool is_any_en_psst_sqr() {
-    for (auto rank : chessboard) {
-        for (auto sq : rank) {
-            if (sq == en_passant_sqr)
-                return true;
-        }
-    }
-    return false;
+void Board::clear_en_passant_sqr() {
+    position.set_state(position.side_to_move(), no_square, position.castling_rights());
 }
 
-Square get_en_passant_sqr() {
-    for (size_t i(0); i < chessboard.size(); ++i) {
-        for (size_t j(0); j < chessboard[i].size(); ++j) {
-            if (chessboard[i][j] == en_passant_sqr)
-                return {char('h'-j), int(i+1)};
-        }
-    }
-    return {blank, 9};
+void Board::write_castling_rights(int rights) {
+    position.set_state(position.side_to_move(), position.ep_square(), rights);
 }
 
-int piece_occurences(char code) {
-    int occurences(0);
-    for (auto rank : chessboard) {
-        for (auto sq : rank) {
-            if (sq == code)
-                ++occurences;
-        }
-    }
-    return occurences;
+void Board::updt_game_state(char code, Square start, Square target) {
+    bool double_push(code_type(code) == PAWN && std::abs(target.rank - start.rank) == 2);
+    position.update_state(square_index(start.file, start.rank),
+                          square_index(target.file, target.rank), double_push);
 }
 
-bool is_friendly(char code, char file, int rank) {
-    char p(chessboard[rank-1][int('h')-int(file)]);
-    if (code >= 'A' && code <= 'R' && p >= 'A' && p <= 'R') {
-        return true;
-    }
-    if (code >= 'a' && code <= 'r' && p >= 'a' && p <= 'r') {
-        return true;
-    }
-    return false;
+bool Board::is_en_passant_sqr(char file, int rank) const {
+    return position.ep_square() == square_index(file, rank);
 }
 
-bool is_enemy(char code, char file, int rank) {
-    char p(chessboard[rank-1][int('h')-int(file)]);
-    if (code >= 'A' && code <= 'R' && p >= 'a' && p <= 'r') {
-        return true;
-    }
-    if (code >= 'a' && code <= 'r' && p >= 'A' && p <= 'R') {
-        return true;
-    }
-    return false;
+int Board::piece_occurences(char code) const {
+    return position.count(code_color(code), code_type(code));
 }
 
-bool is_enemy(bool w_to_play, char file, int rank) {
-    char p(chessboard[rank-1][int('h')-int(file)]);
-    if (w_to_play && (p >= 'b' && p <= 'r'))
-        return true;
-    if (!w_to_play && (p >= 'B' && p <= 'R'))
-        return true;
-    return false;
+bool Board::is_friendly(char code, char file, int rank) const {
+    return position.pieces(code_color(code)) & square_bb(file, rank);
 }
 
-bool is_empty(char file, int rank) {
-    char c(chessboard[rank-1][int('h')-int(file)]);
-    return (c == '.' || c == en_passant_sqr);
+bool Board::is_enemy(char code, char file, int rank) const {
+    return position.pieces(!code_color(code)) & square_bb(file, rank);
 }
 
-bool is_enemy_king(char code, char file, int rank) {
-    char p(chessboard[rank-1][int('h')-int(file)]);
-    return (code >= 'A' && code <= 'R' ? p == 'k' : p == 'K');
+bool Board::is_enemy(bool w_to_play, char file, int rank) const {
+    return position.pieces(w_to_play ? BLACK : WHITE) & square_bb(file, rank);
 }
 
-void board::print_board(bool w_pov, Square start_sqr, Square target_sqr, bool check,
-                                                                        bool cvc) {
-    view::print_board(chessboard, w_pov, start_sqr, target_sqr, check, cvc);
+bool Board::is_empty(char file, int rank) const {
+    return position.is_empty(square_index(file, rank));
 }
 
-void board::print_board(bool w_pov) {
-    view::print_board(chessboard, w_pov);
+bool Board::is_enemy_king(char code, char file, int rank) const {
+    return position.pieces(!code_color(code), KING) & square_bb(file, rank);
 }
@@ -4,55 +4,72 @@
 #include <iostream>
 #include <array>
 #include "common.h"
+#include "position.h"
 
-namespace board {
-    void print_board(bool w_pov, Square start_sqr, Square target_sqr,
-                     bool check, bool cvc);
-    void print_board(bool w_pov);
-}
-
+// Drawn on the square that can be captured en passant
 constexpr char en_passant_sqr('!');
 
-void print_ascii();
+/*
+ * The board of a game: the position written by the players after each move,
+ * with the en passant square and the castling rights. Every game owns its
+ * own board, so several of them can live in one process.
+ */
+class Board {
+public:
+    const Position& get_position() const { return position; }
+    Bitboard get_en_passant_sqrs() const;
 
-void write_piece(char code, char file, int rank);
-void empty_board();
-void write_en_passant_sqr(char file, int rank);
-void clear_en_passant_sqr(char file, int rank);
-void clear_en_passant_sqr();
+    /* The grid drawn by the view, the en passant square included */
+    Chessboard to_chessboard() const;
+    void print_ascii() const;
 
-bool is_en_passant_sqr(char file, int rank);
-bool is_any_en_psst_sqr();
-Square get_en_passant_sqr();
+    void write_piece(char code, char file, int rank);
+    /* Remove every piece, the castling rights and en passant square are kept */
+    void empty_board();
+    void write_en_passant_sqr(char file, int rank);
+    void clear_en_passant_sqr();
+    void write_castling_rights(int rights);
 
-int piece_occurences(char code);
+    /**
+     * Update the en passant square and the castling rights after a move.
+     * @param code The code of the moving piece.
+     * @param start The start square of the move.
+     * @param target The target square of the move.
+     */
+    void updt_game_state(char code, Square start, Square target);
 
-/**
- * @param code The code of the friendly side piece.
- * @param file The square's file.
- * @param rank The square's rank.
- * @return <tt>true</tt> if the square is occupied by a friendly piece.
- */
-bool is_friendly(char code, char file, int rank);
+    bool is_en_passant_sqr(char file, int rank) const;
 
-/**
- * @param code The code of the friendly side piece.
- * @param file The square's file.
- * @param rank The square's rank.
- * @return <tt>true</tt> if the square is occupied by an enemy piece.
- */
-bool is_enemy(char code, char file, int rank);
+    int piece_occurences(char code) const;
 
-/**
- * @param w_to_play If it's White to play.
- * @param file The square's file.
- * @param rank The square's rank.
- * @return <tt>true</tt> if the square is occupied by an enemy piece.
- */
-bool is_enemy(bool w_to_play, char file, int rank);
-bool is_empty(char file, int rank);
-bool is_enemy_king(char code, char file, int rank);
+    /**
+     * @param code The code of the friendly side piece.
+     * @param file The square's file.
+     * @param rank The square's rank.
+     * @return <tt>true</tt> if the square is occupied by a friendly piece.
+     */
+    bool is_friendly(char code, char file, int rank) const;
+
+    /**
+     * @param code The code of the friendly side piece.
+     * @param file The square's file.
+     * @param rank The square's rank.
+     * @return <tt>true</tt> if the square is occupied by an enemy piece.
+     */
+    bool is_enemy(char code, char file, int rank) const;
+
+    /**
+     * @param w_to_play If it's White to play.
+     * @param file The square's file.
+     * @param rank The square's rank.
+     * @return <tt>true</tt> if the square is occupied by an enemy piece.
+     */
+    bool is_enemy(bool w_to_play, char file, int rank) const;
+    bool is_empty(char file, int rank) const;
+    bool is_enemy_king(char code, char file, int rank) const;
 
-// std::vector<Square> get_friendly_sqrs(char code, char file, int rank);
+private:
+    Position position;
+};
 
-#endif
\ No newline at end of file
+#endif
@@ -23,6 +23,8 @@
 #include <string>
 #include <cstring>
 #include <locale>
+#include <algorithm>
+#include <thread>
 #ifdef _WIN32
     #include <io.h>
     #include <fcntl.h>
@@ -30,6 +32,7 @@
 #include "message.h"
 #include "view.h"
 #include "game.h"
+#include "bitboard.h"
 
 int parse_cli_args(int argc, char ** argv, std::wstring prog_name, Game& game, 
                    bool& black, bool& pvp, bool& cvc);
@@ -48,6 +51,7 @@ int main(int argc, char ** argv) {
 #endif
 
     srand((unsigned) time(0));
+    bitboard::init();
 
     std::wstring prog_name;
     size_t pos(0);
@@ -78,50 +82,147 @@ int main(int argc, char ** argv) {
 int parse_cli_args(int argc, char ** argv, std::wstring prog_name, Game& game, 
                    bool& black, bool& pvp, bool& cvc) {
     std::string FEN_filename;
+    SearchLimits limits;
+    bool fen_loaded(false);
     if (argc == 1) {
         usage(prog_name);
         std::wcout << "\n";
     }
 
-    if (argc > 4)
+    // The longest command lines run perft with a depth, a file and every option,
+    // or set every limit of the search.
+    if (argc > 16)
         return 1;
     if (argc >= 2) {
         for (int i(1); i < argc; ++i) {
-            if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--perft") == 0) {
+            if (strcmp(argv[i], "-t") == 0 || strcmp(argv[i], "--perft") == 0
+                || strcmp(argv[i], "--suite") == 0) {
 
+                PerftOptions options;
                 bool depth_arg(false), fen_arg(false);
 
-                if (i+1 < argc) {
-                    if (is_string_an_int(argv[i+1]))
+                // The suite holds its own positions and depths.
+                std::string suite_filename;
+                bool suite(strcmp(argv[i], "--suite") == 0);
+                if (suite) {
+                    if (i+1 >= argc) {
+                        usage(prog_name);
+                        return 1;
+                    }
+                    suite_filename = argv[++i];
+                    depth_arg = fen_arg = true;
+                }
+
+                for (int j(i+1); j < argc; ++j) {
+                    if (strcmp(argv[j], "--threads") == 0) {
+                        if (j+1 >= argc || !is_string_an_int(argv[j+1])
+                            || std::stoi(argv[j+1]) < 1) {
+                            usage(prog_name);
+                            return 1;
+                        }
+                        options.n_threads = std::stoi(argv[++j]);
+                    }else if (strcmp(argv[j], "--hash") == 0) {
+                        if (j+1 >= argc || !is_string_an_int(argv[j+1])) {
+                            usage(prog_name);
+                            return 1;
+                        }
+                        options.hash_mb = std::stoi(argv[++j]);
+                    }else if (strcmp(argv[j], "--checkpoint") == 0) {
+                        if (j+1 >= argc) {
+                            usage(prog_name);
+                            return 1;
+                        }
+                        options.checkpoint = argv[++j];
+                    }else if (strcmp(argv[j], "--no-hash") == 0) {
+                        options.hash_mb = 0;
+                    }else if (strcmp(argv[j], "--divide") == 0) {
+                        options.divide = true;
+                    }else if (strcmp(argv[j], "--stats") == 0) {
+                        options.stats = true;
+                    }else if (!depth_arg && !fen_arg && is_string_an_int(argv[j])) {
+                        options.max_depth = std::stoi(argv[j]);
                         depth_arg = true;
-                    else {
-                        FEN_filename = argv[i+1];
+                    }else if (!fen_arg) {
+                        FEN_filename = argv[j];
                         if (!load_FEN_file(game, FEN_filename))
                             return 1;
                         fen_arg = true;
-                    }
-                }
-
-                if (i+2 < argc) {
-                    FEN_filename = argv[i+2];
-                    if (!load_FEN_file(game, FEN_filename))
+                    }else
                         return 1;
-                    fen_arg = true;
                 }
 
+                if (suite)
+                    return (game.run_suite(suite_filename, options) ? 2 : 1);
+
                 if (!fen_arg)
                     game.parse_fen(ini_board);
 
                 game.updt_board();
                 std::wcout << "Position: \n";
                 game.print_position();
-                if (depth_arg)
-                    game.test_gen_moves(std::stoi(argv[i+1]));
-                else
-                    game.test_gen_moves();
-
+                return (game.test_gen_moves(options) ? 2 : 1);
+            }
+            else if (strcmp(argv[i], "--bench") == 0) {
+                int depth(default_bench_depth);
+                int max_threads(std::max(int(std::thread::hardware_concurrency()), 1));
+                bool depth_arg(false), fen_arg(false);
+                for (int j(i+1); j < argc; ++j) {
+                    if (strcmp(argv[j], "--threads") == 0 || strcmp(argv[j], "--hash") == 0) {
+                        if (j+1 >= argc || !is_string_an_int(argv[j+1])
+                            || std::stoi(argv[j+1]) < 1) {
+                            usage(prog_name);
+                            return 1;
+                        }
+                        if (strcmp(argv[j], "--threads") == 0)
+                            max_threads = std::stoi(argv[++j]);
+                        else
+                            game.set_hash_size(std::stoi(argv[++j]));
+                    }else if (!depth_arg && !fen_arg && is_string_an_int(argv[j])) {
+                        depth = std::max(std::stoi(argv[j]), 1);
+                        depth_arg = true;
+                    }else if (!fen_arg) {
+                        FEN_filename = argv[j];
+                        if (!load_FEN_file(game, FEN_filename))
+                            return 1;
+                        fen_arg = true;
+                    }else
+                        return 1;
+                }
+                if (!fen_arg)
+                    game.parse_fen(ini_board);
+                game.updt_board();
+                game.bench(depth, max_threads);
                 return 2;
             }
+            else if (strcmp(argv[i], "--depth") == 0 || strcmp(argv[i], "--nodes") == 0
+                     || strcmp(argv[i], "--movetime") == 0 || strcmp(argv[i], "--threads") == 0) {
+                if (i+1 >= argc || !is_string_an_int(argv[i+1])) {
+                    usage(prog_name);
+                    return 1;
+                }
+                if (strcmp(argv[i], "--depth") == 0)
+                    limits.depth = std::max(std::stoi(argv[i+1]), 1);
+                else if (strcmp(argv[i], "--nodes") == 0)
+                    limits.nodes = std::stoull(argv[i+1]);
+                else if (strcmp(argv[i], "--threads") == 0)
+                    limits.threads = std::max(std::stoi(argv[i+1]), 1);
+                else    // 0 would mean no time limit
+                    limits.movetime = std::max(std::stoi(argv[i+1]), 1);
+                game.set_search_limits(limits);
+                if (!fen_loaded)
+                    game.parse_fen(ini_board);
+                ++i;
+            }
+            else if (strcmp(argv[i], "--hash") == 0) {
+                if (i+1 >= argc || !is_string_an_int(argv[i+1])
+                    || std::stoi(argv[i+1]) < 1) {
+                    usage(prog_name);
+                    return 1;
+                }
+                game.set_hash_size(std::stoi(argv[++i]));
+                if (!fen_loaded)
+                    game.parse_fen(ini_board);
+            }
             else if (strcmp(argv[i], "-b") == 0 || strcmp(argv[i], "--black") == 0) {
                 black = true;
                 game.parse_fen(ini_board);
@@ -136,10 +237,19 @@ int parse_cli_args(int argc, char ** argv, std::wstring prog_name, Game& game,
                 game.parse_fen(ini_board);
             }
             else if (strcmp(argv[i], "--style") == 0) {
-                if (!customize_style())
+                if (!game.customize_style())
                     return 1;
                 game.parse_fen(ini_board);
             }
+            else if (strcmp(argv[i], "--self-check") == 0) {
+                if (!bitboard::verify_slider_tables()) {
+                    std::wcout << "Sliding attack tables: " << msg_color << "FAILED"
+                               << reset_sgr << "\n";
+                    return 1;
+                }
+                std::wcout << "Sliding attack tables: OK\n";
+                return 2;
+            }
             else if (strcmp(argv[i], "--help") == 0) {
                 usage(prog_name);
                 return 2;
@@ -150,6 +260,7 @@ int parse_cli_args(int argc, char ** argv, std::wstring prog_name, Game& game,
                 FEN_filename = argv[i];
                 if (!load_FEN_file(game, FEN_filename))
                     return 1;
+                fen_loaded = true;
             }            
         }
     }else
@@ -167,7 +278,32 @@ void usage(std::wstring prog_name) {
                << "  -t, --perft [depth=5]\tRun a performance test up to " << italic << "depth"
                << reset_sgr << " plies from the spcified FEN,\n"
                   "\t\t\t  or from the default board if no file is given, then exit.\n"
-               << "  --style\t\tSelect a color scheme for the chessboard.\n\n"
+               << "  --threads N\t\tSearch with " << italic << "N" << reset_sgr
+               << " threads sharing the transposition table. With\n"
+                  "\t\t\t  --perft, share the root moves between " << italic << "N" << reset_sgr
+               << " threads.\n"
+               << "  --hash MB\t\tSize of the transposition table of the engine (16 MB). With\n"
+                  "\t\t\t  --perft, size of the table of subtree counts (16 MB).\n"
+               << "  --no-hash\t\tWith --perft, count every leaf, to time the move generator.\n"
+               << "  --divide\t\tWith --perft, print the count of each root move at the last depth.\n"
+               << "  --stats\t\tWith --perft, also count the captures, castles, checks, etc.\n"
+               << "  --suite FILE\t\tRun perft on every position of an EPD file, to the depths\n"
+                  "\t\t\t  given by its \";D1 20 ;D2 400\" counts, report mismatches, then exit.\n"
+               << "  --checkpoint FILE\tWith --perft, record the count of each root move in "
+               << italic << "FILE" << reset_sgr << ",\n"
+                  "\t\t\t  and skip the moves it already holds. Not with --stats.\n"
+               << "  --depth N\t\tLimit the search of the engine to " << italic << "N"
+               << reset_sgr << " plies.\n"
+               << "  --nodes N\t\tLimit the search of the engine to " << italic << "N"
+               << reset_sgr << " nodes.\n"
+               << "  --movetime MS\t\tLimit the search of the engine to " << italic << "MS"
+               << reset_sgr << " milliseconds (1000), at least 1.\n"
+               << "  --bench [depth=" << default_bench_depth << "]\tSearch the specified FEN, or the default board, to "
+               << italic << "depth" << reset_sgr << " with\n"
+                  "\t\t\t  1, 2, 4... threads up to --threads (all cores), print the\n"
+                  "\t\t\t  speedup of each, then exit.\n"
+               << "  --style\t\tSelect a color scheme for the chessboard.\n"
+               << "  --self-check\t\tVerify the attack tables against the ray walkers, then exit.\n\n"
                << "  --help\t\tPrint this message and exit.\n"
                << "  --version\t\tPrint version information and exit.\n";
 }
@@ -4,8 +4,7 @@
 #include <iostream>
 #include <array>
 
-#define BULK_COUNTING
-// #define DIVIDE
+// #define ATTACK_MAP
 
 constexpr int board_size(8);
 typedef std::array<std::array<char, board_size>, board_size> Chessboard;
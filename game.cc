@@ -21,21 +21,36 @@
 #include <string>
 #include <array>
 #include <cstdlib>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <memory>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
 #include "player.h"
 #include "piece.h"
 #include "board.h"
+#include "bitboard.h"
+#include "position.h"
+#include "move.h"
+#include "movegen.h"
+#include "attackmap.h"
+#include "perft.h"
 #include "message.h"
 #include "view.h"
 #include "common.h"
 #include "game.h"
 
-Game::Game()
+Game::Game(const std::string& _moves_file)
 :   current_move('.', {blank, 0}, {blank, 0}, blank), last_move(current_move),
     SAN_piece(blank), SAN_file(blank), SAN_rank(blank), SAN_spec_file(blank),   
     SAN_spec_rank(blank), SAN_prom_pc(blank), SAN_cap(false), SAN_chk(false),
-    SAN_promote(false), w_turn(true), capture(false), q_castle(false), k_castle(false), check(false), checkmate(false), nb_move(1)
+    SAN_promote(false), w_turn(true), capture(false), q_castle(false), k_castle(false), check(false), checkmate(false), game_over(false),
+    nb_move(1),
+    tt(default_hash_mb), moves_file(_moves_file)
 {
-    message::erase_history_data();
+    message::erase_history_data(moves_file);
 }
 
 Game::~Game() {}
@@ -44,9 +59,21 @@ void Game::game_flow(bool as_black, bool pvp, bool cvc) {
 
     updt_board();
     fen_verify_checks();
+    history.assign(1, current_position(w_turn).key());
     if (pvp || !as_black)
         print_position(w_turn, cvc);
 
+    // A FEN may start the game where it is already over: there is no move to
+    // search or to ask for.
+    if (is_checkmate(!w_turn)) {
+        if (check) {
+            checkmate = true;
+            message::checkmate(!w_turn);
+        }else
+            message::stalemate();
+        return;
+    }
+
     std::wstring SAN;
     while (true) {
 
@@ -65,19 +92,24 @@ void Game::game_flow(bool as_black, bool pvp, bool cvc) {
                 reset_san_variables();
                 prompt_move();
                 std::wcin >> SAN;
-                if (parse_cmd(SAN))
+                if (parse_cmd(SAN)) {
+                    if (game_over)
+                        return;
                     continue;
+                }
 
                 if (is_SAN_valid(SAN)) {
                     // std::wcout << clr_display;
                     Piece* matched_piece(nullptr);
+                    const Position& pos(board.get_position());
                     if (w_turn)
-                        matched_piece = white.unique_piece_for_move(SAN_piece, SAN_file,
-                                                                    SAN_rank, SAN_spec_file, SAN_spec_rank);
+                        matched_piece = white.unique_piece_for_move(pos, SAN_piece, SAN_file,
+                                                                    SAN_rank, SAN_spec_file,
+                                                                    SAN_spec_rank);
                     else
-                        matched_piece = black.unique_piece_for_move(SAN_piece, SAN_file, 
-                                                                    SAN_rank,
-                                                                    SAN_spec_file, SAN_spec_rank);
+                        matched_piece = black.unique_piece_for_move(pos, SAN_piece, SAN_file,
+                                                                    SAN_rank, SAN_spec_file,
+                                                                    SAN_spec_rank);
                     if (!matched_piece)
                         continue;
 
@@ -86,6 +118,7 @@ void Game::game_flow(bool as_black, bool pvp, bool cvc) {
                         continue;
                     }
 
+                    search_info.clear();
                     bool end(process_move(matched_piece, SAN_file, SAN_rank-'0',
                                           w_turn, SAN_prom_pc));
                     if (end)
@@ -155,29 +188,30 @@ void Game::print_position(bool w_ply, bool cvc) {
             std::wcout << '#';
         else if (check)
             std::wcout << '+';
+        // On the same line, so that the display keeps its height.
+        if (!search_info.empty())
+            std::wcout << "\t" << italic << search_info << reset_sgr << clr_end_line;
         std::wcout << "\n";
     }
 
-    board::print_board(w_ply, start, target, check, cvc);
-    // print_ascii();
+    view.print_board(board.to_chessboard(), w_ply, start, target, check, cvc);
+    // board.print_ascii();
 }
 
 void Game::print_position() {
-    board::print_board(w_turn);
+    view.print_board(board.to_chessboard(), w_turn);
 }
 
 void Game::updt_board() {
-    empty_board();
-    white.write_pieces_on_board();
-    black.write_pieces_on_board();
+    board.empty_board();
+    white.write_pieces_on_board(board);
+    black.write_pieces_on_board(board);
     for (size_t i(0); i < white.get_nb_pieces(); ++i) {
-        white.get_piece(i)->updt_cov_sqrs();
+        white.get_piece(i)->updt_cov_sqrs(board.get_position());
     }
     for (size_t i(0); i < black.get_nb_pieces(); ++i) {
-        black.get_piece(i)->updt_cov_sqrs();
+        black.get_piece(i)->updt_cov_sqrs(board.get_position());
     }
-    // white.track_pieces();
-    // black.track_pieces();
 }
 
 bool Game::parse_fen(std::string fen) {
@@ -186,8 +220,9 @@ bool Game::parse_fen(std::string fen) {
     int rank(8);
     int count(0);
     int i(0);
+    int n_kings[2] = {0, 0};
 
-    empty_board();
+    board.empty_board();
     white.delete_pieces();
     black.delete_pieces();
 
@@ -224,6 +259,10 @@ bool Game::parse_fen(std::string fen) {
         }
 
         piece_from_fen(piece, file, rank);
+        if (piece == 'K')
+            ++n_kings[WHITE];
+        else if (piece == 'k')
+            ++n_kings[BLACK];
 
         for (i = 0; i < count; ++i) {
             ++file;
@@ -231,8 +270,15 @@ bool Game::parse_fen(std::string fen) {
         ++c;
     }
 
+    // The move generator relies on the king of each side.
+    if (n_kings[WHITE] != 1 || n_kings[BLACK] != 1) {
+        message::fen_kings_error();
+        return false;
+    }
+
     w_turn = (fen[c] == 'w');
     c += 2;
+    int rights(NO_CASTLING);
     for (i = 0; i < 4; ++i) {
         if (fen[c] == '-') {
             ++c; 
@@ -240,8 +286,29 @@ bool Game::parse_fen(std::string fen) {
         }
         if (fen[c] == ' ')
             break;
+        switch (fen[c]) {
+            case 'K': rights |= WHITE_OO; break;
+            case 'Q': rights |= WHITE_OOO; break;
+            case 'k': rights |= BLACK_OO; break;
+            case 'q': rights |= BLACK_OOO; break;
+            default: break;
+        }
         ++c;
     }
+    // A right is lost if the king or the rook left its initial square.
+    if (!stands_on(white, 'K', 'e', 1))
+        rights &= ~(WHITE_OO | WHITE_OOO);
+    if (!stands_on(white, 'R', 'h', 1))
+        rights &= ~WHITE_OO;
+    if (!stands_on(white, 'R', 'a', 1))
+        rights &= ~WHITE_OOO;
+    if (!stands_on(black, 'k', 'e', 8))
+        rights &= ~(BLACK_OO | BLACK_OOO);
+    if (!stands_on(black, 'r', 'h', 8))
+        rights &= ~BLACK_OO;
+    if (!stands_on(black, 'r', 'a', 8))
+        rights &= ~BLACK_OOO;
+    board.write_castling_rights(rights);
 
     ++c;
     char ep_file(blank);
@@ -255,26 +322,26 @@ bool Game::parse_fen(std::string fen) {
             ep_rank = fen[c] - '0';
         ++c;
     }
+    board.clear_en_passant_sqr();
     if (ep_file != blank) {
         if (ep_rank != 9)
-            write_en_passant_sqr(ep_file, ep_rank);
+            board.write_en_passant_sqr(ep_file, ep_rank);
         else {
             message::fen_parsing_error();
             return false;
         }
     }
 
-    white.track_pieces();
-    black.track_pieces();
-
     return true;
 }
 
+bool Game::stands_on(Player& player, char code, char file, int rank) {
+    Piece* p(player.piece_at(file, rank));
+    return p && p->get_code() == code;
+}
+
 void Game::fen_verify_checks() {
-    if (w_turn) {
-        if (black.attacker()) 
-            check = true;
-    }else if (white.attacker()) 
+    if (board.get_position().in_check(w_turn ? WHITE : BLACK))
         check = true;
 }
 
@@ -312,29 +379,32 @@ bool Game::parse_cmd(std::wstring cmd) {
         return true;
     }
     if (cmd == L"style") {
-        customize_style();
+        view.customize_style();
         print_position(w_turn);
         return true;
     }
     if (cmd == L"auto") {
-        computer_play();
+        // The engine plays for both sides, and either move may end the game.
+        game_over = computer_play();
         updt_board();
-        computer_play();
+        if (game_over)
+            return true;
+        game_over = computer_play();
         updt_board();
-        print_position(w_turn);
+        if (!game_over)
+            print_position(w_turn);
         return true;
     }
     if (cmd == L"moves") {
-        message::open_moves_win();
+        message::open_moves_win(moves_file);
         return true;
     }
     if (cmd == L"gen") {
-        for (auto& move : generate_legal_moves(w_turn)) {
-            std::wcout << move.start.file << move.start.rank
-                       << move.target.file << move.target.rank;
-            if (move.prom != blank)
-                std::wcout << move.prom;
-            std::wcout << "\n";
+        MoveList moves;
+        generate_legal_moves(w_turn, moves);
+        for (auto move : moves) {
+            std::wcout << to_coordinate(move) << "\t"
+                       << to_san(move, board.get_position(), moves) << "\n";
         }
         return true;
     }
@@ -398,7 +468,7 @@ bool Game::is_SAN_valid(std::wstring SAN) {
     SAN_chk = false;
     SAN_cap = false;
     bool done(false);
-    char c, prev;
+    char c, prev(blank);
     for (size_t i(0); i < SAN.length(); ++i) {
         c = SAN[i];
         if (i > 0) 
@@ -520,203 +590,25 @@ void Game::reset_san_variables() {
     SAN_spec_rank = blank;
 }
 
-void Game::make_move(Piece* p, Move move, bool w_ply, bool& k_cstl, bool& q_cstl) {
-
-    if ((w_ply && p->get_code() == 'K') || (!w_ply && p->get_code() == 'k')) {
-        if (move.target.file == p->get_file() + 2)
-            k_cstl = true;
-        else if (move.target.file == p->get_file() - 2)
-            q_cstl = true;
-    }
-
-    k_castle = k_cstl;
-    q_castle = q_cstl;
-
-    if (k_cstl || q_cstl)
-        ++t_result.n_cstls;
-
-    process_move(p, move.target.file, move.target.rank, w_ply, move.prom, true);
-}
-
-void Game::unmake_move(Piece* p, Move move, bool w_ply, bool k_cstl, bool q_cstl) {
-    if (k_cstl)
-        (w_ply ? white.undo_k_castle(true) : black.undo_k_castle(true));
-    else if (q_cstl)
-        (w_ply ? white.undo_q_castle(true) : black.undo_q_castle(true));
-
-    if (w_ply && is_en_passant_sqr(move.start.file, move.start.rank + 1)) {
-        // white.reset_en_passant_sqr();
-        // w_en_psst = false;
-        clear_en_passant_sqr(move.start.file, move.start.rank + 1);
-    }
-    else if (!w_ply && is_en_passant_sqr(move.start.file, move.start.rank - 1)) {
-        // black.reset_en_passant_sqr();
-        // b_en_psst = false;
-        clear_en_passant_sqr(move.start.file, move.start.rank - 1);
-    }
-
-    p->updt_position(move.start.file, move.start.rank, true);
-    p->reveal();
-
-    if (move.prom != blank) {
-        if (w_ply)
-            white.piece_captured(move.target.file, move.target.rank);
-        else
-            black.piece_captured(move.target.file, move.target.rank);
-    }
-    
-    // if (w_ply)
-    //     for (size_t i(0); i < black.get_nb_pieces(); ++i) {
-    //         black.get_piece(i)->reveal();
-    //     }
-    // else
-    //     for (size_t i(0); i < white.get_nb_pieces(); ++i) {
-    //         white.get_piece(i)->reveal();
-    //     }
-
-    updt_board();
-}
-
 bool Game::is_move_legal(Piece* p, char trgt_file, int trgt_rank, bool w_ply) {
-    if (w_ply) {
-        if ((k_castle && !white.can_k_castle()) || (q_castle && !white.can_q_castle()))
-            return false;
-    }else {
-        if ((k_castle && !black.can_k_castle()) || (q_castle && !black.can_q_castle()))
-            return false;
-    }
-
-    // Check for illegal 'king jump'
-    if (p->get_code() == 'K' || p->get_code() == 'k') {
-        if ((!k_castle && trgt_file == p->get_file() + 2) 
-            || (!q_castle && trgt_file == p->get_file() - 2))
-            return false;
-    }
-    
-    bool cap(is_enemy(p->get_code(), trgt_file, trgt_rank)
-             || (is_en_passant_sqr(trgt_file, trgt_rank)
-             && (p->get_code() == 'P' || p->get_code() == 'p')));
-
-    if (handle_check(p, trgt_file, trgt_rank, cap, w_ply))
-        return true;
-
-    return false;
-}
-
-bool Game::handle_check(Piece* piece, char trgt_file, int trgt_rank, bool capt,bool w_p) {
-
-    Square start_sqr({piece->get_file(), piece->get_rank()});
-    // Check that castling doesn't cross a check
-    bool castling_cross_chk(false);
-    if (w_p && k_castle) {
-        for (char f(piece->get_file()); f < 'h'; ++f) {
-            piece->updt_position(f, trgt_rank, true);
-            updt_board();
-            if (black.attacker()) {
-                castling_cross_chk = true;
-                break;
-            }
-        }
-    }else if (w_p && q_castle) {
-        for (char f(piece->get_file()); f > 'b'; --f) {
-            piece->updt_position(f, trgt_rank, true);
-            updt_board();
-            if (black.attacker()) {
-                castling_cross_chk = true;
-                break;
-            }
-        }
-    }else if (!w_p && k_castle) {
-        for (char f(piece->get_file()); f < 'h'; ++f) {
-            piece->updt_position(f, trgt_rank, true);
-            updt_board();
-            if (white.attacker()) {
-                castling_cross_chk = true;
-                break;
-            }
-        }
-    }else if (!w_p && q_castle) {
-        for (char f(piece->get_file()); f > 'b'; --f) {
-            piece->updt_position(f, trgt_rank, true);
-            updt_board();
-            if (white.attacker()) {
-                castling_cross_chk = true;
-                break;
-            }
-        }
-    }
-    if (castling_cross_chk) {
-        piece->updt_position(start_sqr.file, start_sqr.rank, true);
-        updt_board();
+    Move move(p->get_code(), {p->get_file(), p->get_rank()}, {trgt_file, trgt_rank},
+              SAN_prom_pc);
+    PackedMove packed(pack_move(move, board.get_en_passant_sqrs()));
+    // Castling must be asked for, a king jumping two squares is illegal.
+    if (packed.type() == PackedMove::CASTLING && !k_castle && !q_castle)
         return false;
-    }
-
-    // Silently execute the move to see if it leads to a rule violation.
-    bool trgt_is_ep_sqr(is_en_passant_sqr(trgt_file, trgt_rank));
-    piece->updt_position(trgt_file, trgt_rank, true);
 
-    bool illegal(false);
-    if (capt) {
-        if (trgt_is_ep_sqr) {
-            if (w_p) {
-                black.hide_piece(trgt_file, trgt_rank-1);
-                updt_board();
-                if (black.attacker() != nullptr)
-                    illegal = true;
-                black.reveal_piece(trgt_file, trgt_rank-1);
-            }else {
-                white.hide_piece(trgt_file, trgt_rank+1);
-                updt_board();
-                if (white.attacker() != nullptr)
-                    illegal = true;
-                white.reveal_piece(trgt_file, trgt_rank+1);
-            }
-        }else {
-            if (w_p) {
-                black.hide_piece(trgt_file, trgt_rank);
-                updt_board();
-                if (black.attacker() != nullptr)
-                    illegal = true;
-                black.reveal_piece(trgt_file, trgt_rank);
-            }else {
-                white.hide_piece(trgt_file, trgt_rank);
-                updt_board();
-                if (white.attacker() != nullptr)
-                    illegal = true;
-                white.reveal_piece(trgt_file, trgt_rank);
-            }
-        }
-    }else {
-        updt_board();
-        if ((w_p && black.attacker() != nullptr)
-            || (!w_p && white.attacker() != nullptr)) {
-            illegal = true;
-        }
-    }
-    // Replace the piece on its square.
-    piece->updt_position(start_sqr.file, start_sqr.rank, true);
-    
-    if (w_p && white.has_en_passant_sqr()) {
-        clear_en_passant_sqr(trgt_file, trgt_rank-1);
-        white.reset_en_passant_sqr();
-    }else if (!w_p && black.has_en_passant_sqr()) {
-        clear_en_passant_sqr(trgt_file, trgt_rank+1);
-        black.reset_en_passant_sqr();
-    }
-
-    if (trgt_is_ep_sqr)
-        write_en_passant_sqr(trgt_file, trgt_rank);
-    updt_board();
-
-    return !illegal;
+    MoveList moves;
+    generate_legal_moves(w_ply, moves);
+    return moves.contains(packed);
 }
 
 bool Game::process_move(Piece* p, char trgt_file, int trgt_rank, bool w_ply, 
                                                 char prom_piece, bool test) {
 
-    bool ep_cap(is_en_passant_sqr(trgt_file, trgt_rank)
+    bool ep_cap(board.is_en_passant_sqr(trgt_file, trgt_rank)
                 && (p->get_code() == 'P' || p->get_code() == 'p'));
-    bool cap(is_enemy(w_ply, trgt_file, trgt_rank) || ep_cap);
+    bool cap(board.is_enemy(w_ply, trgt_file, trgt_rank) || ep_cap);
     capture = cap;
 
     last_move = current_move;
@@ -727,125 +619,47 @@ bool Game::process_move(Piece* p, char trgt_file, int trgt_rank, bool w_ply,
     if (!w_ply)
         current_move.piece += upcase_shift;
 
-    if (is_any_en_psst_sqr()) {
-        Square ep_sqr(get_en_passant_sqr());
-        if (!w_ply && ep_sqr.rank == 3)
-            clear_en_passant_sqr(ep_sqr.file, ep_sqr.rank);
-        else if (w_ply && ep_sqr.rank == 6)
-            clear_en_passant_sqr(ep_sqr.file, ep_sqr.rank);
-    }
+    board.updt_game_state(p->get_code(), start, target);
+    Player& us(w_ply ? static_cast<Player&>(white) : black);
+    Player& them(w_ply ? static_cast<Player&>(black) : white);
     // Update position and in-range squares of the active piece
-    p->updt_position(trgt_file, trgt_rank, test);
+    us.move_piece(p, trgt_file, trgt_rank, test);
     updt_board();
     // Castling
-    if (w_ply) {
-        if (k_castle) {
-            white.castle_king_side(test);
-        }
-        else if (q_castle) {
-            white.castle_queen_side(test);
-        }
-    }else if (k_castle) {
-        black.castle_king_side(test);
-    }
-    else if (q_castle) {
-        black.castle_queen_side(test);
-    }
-
-    // Detect any en-passant square
-    // if (white.has_en_passant_sqr())
-    //     w_en_psst = true;
-    // else if (black.has_en_passant_sqr())
-    //     b_en_psst = true;
+    if (k_castle)
+        us.castle_king_side(test);
+    else if (q_castle)
+        us.castle_queen_side(test);
 
     // Delete the captured piece if there is any.
     // Hide it, i.e. make it inactive and unseeable while keeping it in memory
     // when this function is called by 'compute_moves'
     if (cap) {
-        if (w_ply) {
-            if (ep_cap) {
-                ++t_result.n_ep;
-                // std::wcout << "epcap\n";
-                if (test)
-                    black.hide_piece(trgt_file, trgt_rank-1);
-                else
-                    black.piece_captured(trgt_file, trgt_rank-1);
-            }else {
-                ++t_result.n_cptrs;
-                if (test)
-                    black.hide_piece(trgt_file, trgt_rank);
-                else
-                    black.piece_captured(trgt_file, trgt_rank);
-            }
-            if (!test)
-                black.track_pieces();
-        }else {
-            if (ep_cap) {
-                ++t_result.n_ep;
-                if (test)
-                    white.hide_piece(trgt_file, trgt_rank+1);
-                else
-                    white.piece_captured(trgt_file, trgt_rank+1);
-            }else {
-                ++t_result.n_cptrs;
-                if (test)
-                    white.hide_piece(trgt_file, trgt_rank);
-                else
-                    white.piece_captured(trgt_file, trgt_rank);
-            }
-            if (!test)
-                white.track_pieces();
-        }
+        // A pawn captured en passant stands behind the target square.
+        int cap_rank(ep_cap ? trgt_rank + (w_ply ? -1 : 1) : trgt_rank);
+        if (test)
+            them.hide_piece(trgt_file, cap_rank);
+        else
+            them.piece_captured(trgt_file, cap_rank);
     }
 
-    if (SAN_promote) {
-        if (w_ply) {
-            white.piece_captured(trgt_file, trgt_rank);
-            white.new_piece(SAN_prom_pc, trgt_file, trgt_rank);
-            white.track_pieces();
-        }else {
-            black.piece_captured(trgt_file, trgt_rank);
-            black.new_piece(SAN_prom_pc - upcase_shift, trgt_file, trgt_rank);
-            black.track_pieces();
-        }
-    }else if (w_ply && p->get_code() == 'P' && trgt_rank == 8) {
-        ++t_result.n_proms;
+    if (SAN_promote || (p->get_type() == PAWN && (trgt_rank == 1 || trgt_rank == board_size))) {
+        char prom(SAN_promote ? SAN_prom_pc : prom_piece);
         if (test)
-            white.hide_piece(trgt_file, trgt_rank);
-        else {
-            white.piece_captured(trgt_file, trgt_rank);
-            white.track_pieces();
-        }
-        white.new_piece(prom_piece + upcase_shift, trgt_file, trgt_rank);
-    }else if (!w_ply && p->get_code() == 'p' && trgt_rank == 1) {
-        ++t_result.n_proms;
-        if (test)
-            black.hide_piece(trgt_file, trgt_rank);
-        else {
-            black.piece_captured(trgt_file, trgt_rank);
-            black.track_pieces();
-        }
-        black.new_piece(prom_piece, trgt_file, trgt_rank);
+            us.hide_piece(trgt_file, trgt_rank);
+        else
+            us.piece_captured(trgt_file, trgt_rank);
+        us.new_piece(piece_code(w_ply ? WHITE : BLACK, code_type(prom)), trgt_file, trgt_rank);
     }
 
-    if (w_ply) {
-        if (white.attacker()) {
-            check = true;
-            ++t_result.n_chks;
-        }else {
-            check = false;
-            if (SAN_chk)
-                std::wcout << msg_color << "this is not a check\n" << reset_sgr;
-        }
-    }else {
-        if (black.attacker()) {
-            check = true;
-            ++t_result.n_chks;
-        }else {
-            check = false;
-            if (SAN_chk)
-                std::wcout << msg_color << "This is not a check\n" << reset_sgr;
-        }
+    // Rewrite the board first: the castling rook or a promoted piece may give check.
+    updt_board();
+    if (board.get_position().in_check(w_ply ? BLACK : WHITE))
+        check = true;
+    else {
+        check = false;
+        if (SAN_chk)
+            std::wcout << msg_color << "This is not a check\n" << reset_sgr;
     }
 
     // if (w_en_psst && !w_ply) {
@@ -859,16 +673,15 @@ bool Game::process_move(Piece* p, char trgt_file, int trgt_rank, bool w_ply,
     // }
     
     if (!test) {
+        history.push_back(current_position(!w_ply).key());
         if (check) {
             if (is_checkmate(w_ply)) {
                 checkmate = true;
-                message::write_to_history(current_move, w_ply, nb_move, capture, check,
-                                                                             checkmate);
+                message::write_to_history(moves_file, current_move, w_ply, nb_move, capture,
+                                          check, checkmate);
                 message::checkmate(w_ply);
                 updt_board();
                 print_position(!w_ply);
-                ++t_result.n_chkmates;
-                --t_result.n_chks;
                 return true;
             }
         }else if (is_draw(w_ply)) {
@@ -879,7 +692,8 @@ bool Game::process_move(Piece* p, char trgt_file, int trgt_rank, bool w_ply,
     }
 
     if (!test)
-        message::write_to_history(current_move, w_ply, nb_move, capture, check, checkmate);
+        message::write_to_history(moves_file, current_move, w_ply, nb_move, capture, check,
+                                  checkmate);
 
     // if (test && !w_ply)
     //     print_position(true);
@@ -888,36 +702,7 @@ bool Game::process_move(Piece* p, char trgt_file, int trgt_rank, bool w_ply,
 }
 
 bool Game::is_checkmate(bool w_ply) {
-    Piece* piece(nullptr);
-    bool cap(false);
-    if (w_ply) {
-        size_t nb(black.get_nb_pieces());
-        for (size_t i(0); i < nb; ++i) {
-            piece = black.get_piece(i);
-            for (auto sq : piece->get_cov_sqrs()) {
-                cap = false;
-                if (is_enemy(piece->get_code(), sq.file, sq.rank)
-                    || is_en_passant_sqr(sq.file, sq.rank))
-                    cap = true;
-                if (handle_check(piece, sq.file, sq.rank, cap, !w_ply))
-                    return false;
-            } 
-        }
-    }else {
-        size_t nb(white.get_nb_pieces());
-        for (size_t i(0); i < nb; ++i) {
-            piece = white.get_piece(i);
-            for (auto sq : piece->get_cov_sqrs()) {
-                cap = false;
-                if (is_enemy(piece->get_code(), sq.file, sq.rank)
-                    || is_en_passant_sqr(sq.file, sq.rank))
-                    cap = true;
-                if (handle_check(piece, sq.file, sq.rank, cap, !w_ply))
-                    return false;
-            }
-        }
-    }
-    return true;
+    return movegen::count_legal(current_position(!w_ply)) == 0;
 }
 
 bool Game::is_draw(bool w_ply) {
@@ -931,6 +716,11 @@ bool Game::is_draw(bool w_ply) {
         message::stalemate();
         return true;
     }
+    // Threefold repetition, the last position being the current one
+    if (!history.empty() && std::count(history.begin(), history.end(), history.back()) >= 3) {
+        message::draw();
+        return true;
+    }
     return false;
 }
 
@@ -960,10 +750,15 @@ bool Game::computer_play() {
     reset_san_variables();
     Piece* p(nullptr);
 
-    std::vector<Move> moves(generate_legal_moves(w_turn));
+    Search search(limits, tt, history);
+    SearchResult result(search.run(current_position(w_turn)));
+    search_info = to_string(result);
 
-    size_t i(rand() % moves.size());
-    Move move(moves[i]);
+    Move move(unpack_move(result.best, board.get_position()));
+    if (result.best.type() == PackedMove::CASTLING) {
+        k_castle = (move.target.file == 'g');
+        q_castle = !k_castle;
+    }
     if (w_turn)
         p = white.find_piece(move.piece, move.start.file, move.start.rank);
     else
@@ -975,380 +770,232 @@ bool Game::computer_play() {
     return false;
 }
 
-void Game::test_gen_moves(int max_depth) {
-
-#ifndef DIVIDE
-    for (int i(1); i <= max_depth; ++i) {
-        t_result = {0, 0, 0, 0, 0};
-        perft_depth = i;
-
-        std::wcout << "depth: " << i
-                   << "\tnodes: " << save_cursor_pos << msg_color
-                   << compute_moves(i, w_turn) << reset_sgr;
-    #ifndef BULK_COUNTING
-        std::wcout << "\tcaptures: " << msg_color << t_result.n_cptrs << reset_sgr
-                   << "\te-p: " << msg_color << t_result.n_ep << reset_sgr
-                   << "\tcastles: " << msg_color << t_result.n_cstls << reset_sgr
-                   << "\tpromotions: " << msg_color << t_result.n_proms << reset_sgr
-                   << "\tchecks: " << msg_color << t_result.n_chks << reset_sgr
-                   << "\tcheckmates: " << msg_color << t_result.n_chkmates << reset_sgr;
-    #endif // BULK_COUNTING
-        std::wcout << "\n";
-    }
-#else
-    perft_depth = max_depth;
-    std::wcout << divide(max_depth, w_turn) << "\n\n";
-#endif // DIVIDE
-}
+bool Game::test_gen_moves(const PerftOptions& options) {
 
-int Game::divide(int depth, bool w_ply) {
-
-    std::vector<Move> moves(generate_moves(w_ply));
-    Piece* p(nullptr);
-    int n_positions(0);
-    for (auto move : moves) {
-
-        std::wcout << move.start.file << move.start.rank
-                   << move.target.file << move.target.rank;
-        if (move.prom != blank)
-            std::wcout << move.prom;
-        std::wcout << ": ";
-        if (depth == 1) {
-            std::wcout << "1\n";
-            continue;
-        }
-
-        bool k_cstl(false), q_cstl(false);
-        if (w_ply)
-            p = white.find_piece(move.piece, move.start.file, move.start.rank);
-        else
-            p = black.find_piece(move.piece, move.start.file, move.start.rank);
-
-        Square enemy_ep_sqr;
-        bool is_enemy_ep_sqr(false);
-        if (is_any_en_psst_sqr()) {
-            enemy_ep_sqr = {get_en_passant_sqr().file, get_en_passant_sqr().rank};
-            is_enemy_ep_sqr = true;
+    Position root(current_position(w_turn));
+    MoveList moves;
+    movegen::generate_legal(root, moves);
+    std::unique_ptr<PerftTable> table;
+    if (options.hash_mb > 0 && !options.stats)
+        table.reset(new PerftTable(options.hash_mb));
+    std::unique_ptr<Checkpoint> checkpoint;
+    if (!options.checkpoint.empty()) {
+        // The moves resumed would add their count, but none of their statistics.
+        if (options.stats) {
+            message::checkpoint_stats_error();
+            return false;
         }
-
-        bool cap(is_enemy(w_ply, move.target.file, move.target.rank));
-        bool ep_cap(is_en_passant_sqr(move.target.file, move.target.rank)
-                    && (p->get_code() == 'P' || p->get_code() == 'p'));
-
-        make_move(p, move, w_ply, k_cstl, q_cstl);
-        if (is_move_legal(p, move.target.file, move.target.rank, w_ply)) {
-            int n_nodes(compute_moves(depth-1, !w_ply));
-            n_positions += n_nodes;
-            std::wcout << n_nodes << "\n";
+        checkpoint.reset(new Checkpoint(options.checkpoint));
+        if (checkpoint->malformed_line()) {
+            message::checkpoint_line_error(options.checkpoint, checkpoint->malformed_line());
+            return false;
         }
-        unmake_move(p, move, w_ply, k_cstl, q_cstl);
-
-        if (is_enemy_ep_sqr)
-            write_en_passant_sqr(enemy_ep_sqr.file, enemy_ep_sqr.rank);
-
-        if (cap) {
-            if (w_ply) {
-                black.reveal_piece(move.target.file, move.target.rank);
-            }else {
-                white.reveal_piece(move.target.file, move.target.rank);
-            }
-        }else if (ep_cap) {
-            write_en_passant_sqr(move.target.file, move.target.rank);
-            if (w_ply) {
-                black.reveal_piece(move.target.file, move.target.rank-1);
-            }else {
-                white.reveal_piece(move.target.file, move.target.rank+1);
-            }
+        if (!checkpoint->is_open()) {
+            message::checkpoint_error(options.checkpoint);
+            return false;
         }
-        updt_board();
     }
-    std::wcout << "\nNodes searched: ";
-    if (depth == 1)
-        return moves.size();
-    return n_positions;
-}
-
-int Game::compute_moves(int depth, bool w_ply) {
-
-#ifdef BULK_COUNTING
-    // if (depth == 1)
-    //     print_position(true);
-    std::vector<Move> moves(generate_legal_moves(w_ply));
-    if (depth == 1) {
-        // std::wcout << restore_cursor_pos << clr_end_line;
-        return moves.size();
-    }
-#else
-    if (depth == 0) {
-        return 1;
+    std::vector<Perft> workers(std::max(options.n_threads, 1), Perft(root, table.get(), options.stats));
+    std::vector<uint64_t> counts, nodes;
+    int max_depth(options.max_depth);
+    double seconds(0);
+    // Divide only looks at the counts of the last depth.
+    for (int i(options.divide ? max_depth : 1); i <= max_depth; ++i) {
+        auto begin(std::chrono::steady_clock::now());
+        std::wcout << "depth: " << i << "\tnodes: " << save_cursor_pos;
+        size_t n_resumed(perft::run(moves, i, workers, checkpoint.get(), counts, nodes, true));
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+
+        TestResult result{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+        for (auto& worker : workers)
+            result += worker.get_result();
+        uint64_t n_nodes(0);
+        for (auto n : counts)
+            n_nodes += n;
+
+        std::wcout << msg_color << n_nodes << reset_sgr;
+        if (options.stats) {
+            std::wcout << "\tcaptures: " << msg_color << result.n_cptrs << reset_sgr
+                       << "\te-p: " << msg_color << result.n_ep << reset_sgr
+                       << "\tcastles: " << msg_color << result.n_cstls << reset_sgr
+                       << "\tpromotions: " << msg_color << result.n_proms << reset_sgr
+                       << "\tchecks: " << msg_color << result.n_chks << reset_sgr
+                       << "\tcheckmates: " << msg_color << result.n_chkmates << reset_sgr;
+        }
+    #ifdef ATTACK_MAP
+        std::wcout << "\tslider updates: " << msg_color << result.n_atck_updts << reset_sgr
+                   << "\tavoided: " << msg_color << result.n_atck_skips << reset_sgr;
+    #endif // ATTACK_MAP
+        if (table) {
+            std::wcout << "\thash hits: " << msg_color
+                       << (result.n_probes ? 100.0 * result.n_hits / result.n_probes : 0.0)
+                       << "%" << reset_sgr << "\tfrom hash: " << result.n_hashed;
+        }
+        if (n_resumed)
+            std::wcout << "\tresumed: " << msg_color << n_resumed << "/" << moves.size()
+                       << reset_sgr;
+        std::wcout << "\n";
     }
-    std::vector<Move> moves(generate_legal_moves(w_ply));
-#endif // BULK_COUNTING
-
-    Piece* p(nullptr);
-    int n_positions(0);
-    size_t i(0);
-
-    for (auto move : moves) {        
-        if (depth == perft_depth) {
-            std::wcout << restore_cursor_pos << clr_end_line << msg_color
-                       << ++i << "/" << moves.size() << "\n";
-            if (i == moves.size())
-                std::wcout << restore_cursor_pos << clr_end_line << msg_color;
-        }
-
-        // std::wcout << move.start.file << move.start.rank
-        //            << move.target.file << move.target.rank << "\n";
-
-        bool k_cstl(false), q_cstl(false);
-
-        if (w_ply)
-            p = white.find_piece(move.piece, move.start.file, move.start.rank);
-        else
-            p = black.find_piece(move.piece, move.start.file, move.start.rank);
-
-        Square enemy_ep_sqr;
-        bool is_enemy_ep_sqr(false);
-        if (is_any_en_psst_sqr()) {
-            enemy_ep_sqr = {get_en_passant_sqr().file, get_en_passant_sqr().rank};
-            is_enemy_ep_sqr = true;
-        }
 
-        bool cap(is_enemy(w_ply, move.target.file, move.target.rank));
-        bool ep_cap(is_en_passant_sqr(move.target.file, move.target.rank)
-                    && (p->get_code() == 'P' || p->get_code() == 'p'));
-
-        make_move(p, move, w_ply, k_cstl, q_cstl);
-        // if (is_move_legal(p, move.target.file, move.target.rank, w_ply))
-        n_positions += compute_moves(depth-1, !w_ply);
-        unmake_move(p, move, w_ply, k_cstl, q_cstl);
-
-        if (is_enemy_ep_sqr)
-            write_en_passant_sqr(enemy_ep_sqr.file, enemy_ep_sqr.rank);
-
-        if (cap) {
-            if (w_ply) {
-                black.reveal_piece(move.target.file, move.target.rank);
-            }else {
-                white.reveal_piece(move.target.file, move.target.rank);
-            }
-        }else if (ep_cap) {
-            write_en_passant_sqr(move.target.file, move.target.rank);
-            if (w_ply) {
-                black.reveal_piece(move.target.file, move.target.rank-1);
-            }else {
-                white.reveal_piece(move.target.file, move.target.rank+1);
-            }
-        }
-        updt_board();
+    if (options.divide) {
+        std::wcout << "\n";
+        for (size_t i(0); i < moves.size(); ++i)
+            std::wcout << to_coordinate(moves[i]) << ": " << counts[i] << "\n";
+    }
+
+    // Speed of the deepest iteration, which dominates the run, over the leaves
+    // counted: those read from the table cost nothing to generate.
+    uint64_t n_nodes(0);
+    for (auto n : nodes)
+        n_nodes += n;
+    std::wcout << "\nthreads: " << workers.size()
+               << "\thash: " << (table ? table->size_mb() : 0) << " MB"
+               << "\ttime: " << int(seconds * 1000) << " ms"
+               << "\tnps: " << uint64_t(n_nodes / std::max(seconds, 1e-6)) << "\n";
+    if (workers.size() > 1) {
+        for (size_t id(0); id < workers.size(); ++id)
+            std::wcout << "  thread " << id << ": " << nodes[id] << " nodes counted\n";
     }
- 
-    return n_positions;
+    return true;
 }
 
-// Negamax Framework
-int Game::search(int depth, int alpha, int beta, bool w_ply) {
-    std::vector<Move> moves(generate_legal_moves(w_ply));
-    if (depth == 0) {
-        // std::wcout << restore_cursor_pos << clr_end_line;
-        return evaluate(w_ply);
-    }
-    /*
-     * if (depth == 0)
-     *     return quiesce(alpha, beta);
-     */
-
-    if (moves.empty()) {
-        if (check)
-            return -INFINITY;
-        return 0;
-    }
-
-    Piece* p(nullptr);
-    size_t i(0);
-
-    for (auto move : moves) {        
-        if (depth == perft_depth) {
-            std::wcout << restore_cursor_pos << clr_end_line << msg_color
-                       << ++i << "/" << moves.size() << "\n";
-            if (i == moves.size())
-                std::wcout << restore_cursor_pos << clr_end_line << msg_color;
-        }
-
-        if (w_ply)
-            p = white.find_piece(move.piece, move.start.file, move.start.rank);
-        else
-            p = black.find_piece(move.piece, move.start.file, move.start.rank);
-
-        Square enemy_ep_sqr;
-        bool is_enemy_ep_sqr(is_any_en_psst_sqr());
-        if (is_enemy_ep_sqr)
-            enemy_ep_sqr = {get_en_passant_sqr().file, get_en_passant_sqr().rank};
-
-        bool k_cstl(false), q_cstl(false);
-        bool cap(is_enemy(w_ply, move.target.file, move.target.rank));
-        bool ep_cap(is_en_passant_sqr(move.target.file, move.target.rank)
-                    && (p->get_code() == 'P' || p->get_code() == 'p'));
-
-        make_move(p, move, w_ply, k_cstl, q_cstl);
-        int evaluation(-search(depth-1, -beta, -alpha, !w_ply));
-        unmake_move(p, move, w_ply, k_cstl, q_cstl);
-        if (evaluation >= beta)
-            return beta;
-        alpha = std::max(alpha, evaluation);
-
-        if (is_enemy_ep_sqr)
-            write_en_passant_sqr(enemy_ep_sqr.file, enemy_ep_sqr.rank);
-
-        if (cap) {
-            if (w_ply) {
-                black.reveal_piece(move.target.file, move.target.rank);
-            }else {
-                white.reveal_piece(move.target.file, move.target.rank);
-            }
-        }else if (ep_cap) {
-            write_en_passant_sqr(move.target.file, move.target.rank);
-            if (w_ply) {
-                black.reveal_piece(move.target.file, move.target.rank-1);
-            }else {
-                white.reveal_piece(move.target.file, move.target.rank+1);
-            }
-        }
-        updt_board();
+bool Game::run_suite(const std::string& filename, const PerftOptions& options) {
+    std::ifstream suite(filename);
+    if (suite.fail()) {
+        message::fen_file_not_found(filename);
+        return false;
     }
-    return alpha;
-}
-
-int Game::evaluate(bool w_ply) {
-    int w_material(count_material(true));
-    int b_material(count_material(false));
-
-    return (w_ply ? w_material - b_material : b_material - w_material);
-}
-
-int Game::count_material(bool w_ply) {
-    int material(0);
-    material += piece_occurences(w_ply ? 'P' : 'p');
-    material += piece_occurences(w_ply ? 'N' : 'n');
-    material += piece_occurences(w_ply ? 'B' : 'b');
-    material += piece_occurences(w_ply ? 'R' : 'r');
-    material += piece_occurences(w_ply ? 'Q' : 'q');
-    return material;
-}
-
-std::vector<Move> Game::generate_moves(bool w_ply) {
-
-    size_t n;
-    Piece* p(nullptr);
-    std::vector<Move> pseudo_legal_moves;
-
-    if (w_ply)
-        n = white.get_nb_pieces();
-    else
-        n = black.get_nb_pieces();
-
-    for (size_t i(0); i < n; ++i) {
-        p = (w_ply ? white.get_piece(i) : black.get_piece(i));
-        if (p->get_hidden())
+    std::unique_ptr<PerftTable> table;
+    if (options.hash_mb > 0 && !options.stats)
+        table.reset(new PerftTable(options.hash_mb));
+
+    int n_positions(0), n_mismatches(0);
+    // All the leaves, and those the move generator counted, for the speed
+    uint64_t total_nodes(0), total_counted(0);
+    double total_seconds(0);
+    std::string line;
+    while (std::getline(suite, line)) {
+        // The FEN comes first, then the expected counts as ";D<depth> <nodes>".
+        size_t ops(line.find(';'));
+        if (ops == std::string::npos)
+            continue;
+        std::string fen(line.substr(0, ops));
+        std::wcout << "position " << ++n_positions << ": "
+                   << std::wstring(fen.begin(), fen.end()) << "\n";
+        if (!parse_fen(fen)) {
+            ++n_mismatches;
             continue;
-        
-        for (auto& sq : p->get_cov_sqrs()) {
-            if ((w_ply && p->get_code() == 'P' && sq.rank == 8)
-                || (!w_ply && p->get_code() == 'p' && sq.rank == 1)) {
-
-                pseudo_legal_moves.push_back(Move(p->get_code(),
-                                            {p->get_file(), p->get_rank()},
-                                            {sq.file, sq.rank},
-                                            'q'));
-                pseudo_legal_moves.push_back(Move(p->get_code(),
-                                            {p->get_file(), p->get_rank()},
-                                            {sq.file, sq.rank},
-                                            'r'));
-                pseudo_legal_moves.push_back(Move(p->get_code(),
-                                            {p->get_file(), p->get_rank()},
-                                            {sq.file, sq.rank},
-                                            'b'));
-                pseudo_legal_moves.push_back(Move(p->get_code(),
-                                            {p->get_file(), p->get_rank()},
-                                            {sq.file, sq.rank},
-                                            'n'));
-            }else {
-                pseudo_legal_moves.push_back(Move(p->get_code(),
-                                           {p->get_file(), p->get_rank()},
-                                           {sq.file, sq.rank},
-                                           blank));
-            }
         }
-    }
-    return pseudo_legal_moves;
-}
-
-std::vector<Move> Game::generate_legal_moves(bool w_ply) {
-
-    size_t n;
-    Piece* p(nullptr);
-    std::vector<Move> legal_moves;
-
-    if (w_ply)
-        n = white.get_nb_pieces();
-    else
-        n = black.get_nb_pieces();
-
-    for (size_t i(0); i < n; ++i) {
+        updt_board();
 
-        if (w_ply)
-            p = white.get_piece(i);
-        else
-            p = black.get_piece(i);
-        
-        if (p->get_hidden())
-            continue;
-        
-        for (auto& sq : p->get_cov_sqrs()) {
-            k_castle = false;
-            q_castle = false;
-            // std::wcout << p->get_file() << p->get_rank() << sq.file << sq.rank << "\n";
-            
-            if ((w_ply && p->get_code() == 'K') || (!w_ply && p->get_code() == 'k')) {
-                if (sq.file == p->get_file() + 2)
-                    k_castle = true;
-                else if (sq.file == p->get_file() - 2)
-                    q_castle = true;
+        Position root(current_position(w_turn));
+        MoveList moves;
+        movegen::generate_legal(root, moves);
+        std::vector<Perft> workers(std::max(options.n_threads, 1), Perft(root, table.get(), options.stats));
+        std::vector<uint64_t> counts, nodes;
+
+        uint64_t pos_nodes(0), pos_counted(0);
+        double pos_seconds(0);
+        int n_depths(0);
+        std::istringstream operations(line.substr(ops + 1));
+        std::string op;
+        // Operations run up to the next ';'. Only the "D<depth> <nodes>" ones are read.
+        while (std::getline(operations, op, ';')) {
+            std::istringstream fields(op);
+            std::string name, extra;
+            uint64_t n_expected;
+            if (!(fields >> name) || name[0] != 'D')
+                continue;
+            std::string digits(name.substr(1));
+            bool valid(!digits.empty() && digits.size() <= 3
+                       && digits.find_first_not_of("0123456789") == std::string::npos
+                       && (fields >> n_expected) && !(fields >> extra));
+            int depth(valid ? std::stoi(digits) : 0);
+            if (depth < 1 || depth >= max_ply) {
+                ++n_mismatches;
+                std::wcout << "  " << msg_color << "MALFORMED" << reset_sgr << " operation \";"
+                           << std::wstring(op.begin(), op.end()) << "\"\n";
+                continue;
             }
-
-            if ((w_ply && p->get_code() == 'P' && sq.rank == 8)
-                || (!w_ply && p->get_code() == 'p' && sq.rank == 1)) {
-
-                if (is_move_legal(p, sq.file, sq.rank, w_ply)) {
-                    legal_moves.push_back(Move(p->get_code(),
-                                               {p->get_file(), p->get_rank()},
-                                               {sq.file, sq.rank},
-                                               'q'));
-                    legal_moves.push_back(Move(p->get_code(),
-                                               {p->get_file(), p->get_rank()},
-                                               {sq.file, sq.rank},
-                                               'r'));
-                    legal_moves.push_back(Move(p->get_code(),
-                                               {p->get_file(), p->get_rank()},
-                                               {sq.file, sq.rank},
-                                               'b'));
-                    legal_moves.push_back(Move(p->get_code(),
-                                               {p->get_file(), p->get_rank()},
-                                               {sq.file, sq.rank},
-                                               'n'));
-                }
-            }else if (is_move_legal(p, sq.file, sq.rank, w_ply)) {
-                legal_moves.push_back(Move(p->get_code(),
-                                           {p->get_file(), p->get_rank()},
-                                           {sq.file, sq.rank},
-                                           blank));
+            ++n_depths;
+
+            auto begin(std::chrono::steady_clock::now());
+            // No progress: the suite is meant to run unattended, its output logged.
+            std::wcout << "  depth: " << depth << "\tnodes: ";
+            perft::run(moves, depth, workers, nullptr, counts, nodes, false);
+            double seconds(std::chrono::duration<double>(std::chrono::steady_clock::now()
+                                                         - begin).count());
+            uint64_t n_nodes(0);
+            for (auto n : counts)
+                n_nodes += n;
+            pos_nodes += n_nodes;
+            for (auto n : nodes)
+                pos_counted += n;
+            pos_seconds += seconds;
+
+            std::wcout << msg_color << n_nodes << reset_sgr;
+            if (n_nodes != n_expected) {
+                ++n_mismatches;
+                std::wcout << "\t" << msg_color << "MISMATCH" << reset_sgr
+                           << ", expected " << n_expected;
             }
+            std::wcout << "\n";
         }
-    }
-    // for (auto move : legal_moves) {
-    //    std::wcout << move.start.file << move.start.rank
-    //               << move.target.file << move.target.rank << "\n";
-    // }
-
-    return legal_moves;
+        // A line that checks nothing must not pass unnoticed.
+        if (!n_depths) {
+            ++n_mismatches;
+            std::wcout << "  " << msg_color << "NO DEPTH" << reset_sgr
+                       << ", expected \";D<depth> <nodes>\" operations\n";
+        }
+        std::wcout << "  nodes: " << pos_nodes << "\ttime: " << int(pos_seconds * 1000)
+                   << " ms\tnps: " << uint64_t(pos_counted / std::max(pos_seconds, 1e-6))
+                   << "\n\n";
+        total_nodes += pos_nodes;
+        total_counted += pos_counted;
+        total_seconds += pos_seconds;
+    }
+
+    std::wcout << "positions: " << n_positions << "\tnodes: " << total_nodes
+               << "\ttime: " << int(total_seconds * 1000) << " ms"
+               << "\tnps: " << uint64_t(total_counted / std::max(total_seconds, 1e-6))
+               << "\tmismatches: " << msg_color << n_mismatches << reset_sgr << "\n";
+    return n_mismatches == 0;
+}
+
+void Game::bench(int depth, int max_threads) {
+    Position root(current_position(w_turn));
+    SearchLimits bench_limits{depth, 0, 0, 1};
+    std::vector<int> n_threads;
+    for (int n(1); n < max_threads; n *= 2)
+        n_threads.push_back(n);
+    n_threads.push_back(max_threads);
+
+    double base_seconds(0);
+    std::wcout << "Time to depth " << depth << ":\n";
+    for (int n : n_threads) {
+        // Each run starts from an empty table, so that none reuses the results of another.
+        tt.clear();
+        bench_limits.threads = n;
+        Search search(bench_limits, tt, history);
+        SearchResult result(search.run(root));
+        if (n == 1)
+            base_seconds = result.seconds;
+        std::wcout << "threads: " << n << "\ttime: " << int(result.seconds * 1000) << " ms"
+                   << "\tnodes: " << result.nodes
+                   << "\tspeedup: " << msg_color << std::fixed << std::setprecision(2)
+                   << base_seconds / std::max(result.seconds, 1e-6) << std::defaultfloat
+                   << reset_sgr
+                   << "\tbest: " << to_coordinate(result.best) << "\n";
+    }
+}
+
+Position Game::current_position(bool w_ply) {
+    Position pos(board.get_position());
+    // The en passant square is always the one left by the last move.
+    pos.set_state(w_ply ? WHITE : BLACK, pos.ep_square(), pos.castling_rights());
+    return pos;
+}
+
+void Game::generate_legal_moves(bool w_ply, MoveList& moves) {
+    movegen::generate_legal(current_position(w_ply), moves);
 }
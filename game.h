@@ -2,26 +2,28 @@
 #define GAME_H
 
 #include <string>
+#include <cstdint>
+#include <vector>
 #include "player.h"
-
-#define INFINITY 10e4
+#include "move.h"
+#include "attackmap.h"
+#include "perft.h"
+#include "search.h"
+#include "board.h"
+#include "view.h"
+#include "message.h"
 
 const std::wstring king_castle(L"O-O");
 const std::wstring queen_castle(L"O-O-O");
 const std::string ini_board("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
 
-struct TestResult {
-    int n_cptrs;
-    int n_ep;
-    int n_cstls;
-    int n_proms;
-    int n_chks;
-    int n_chkmates;
-};
-
 class Game {
 public:
-    Game();
+    /**
+     * @param moves_file The file the moves of the game are written to, so
+     *        that two games don't write to the same one.
+     */
+    Game(const std::string& moves_file=message::moves_history_file);
     virtual ~Game();
     void game_flow(bool black, bool pvp, bool cvc);
     void prompt_move();
@@ -41,15 +43,41 @@ public:
     int is_resign();
     void resign();
 
+    /**
+     * Let the engine search the position and play its best move.
+     * @return <tt>true</tt> if the move ends the game.
+     */
     bool computer_play();
-
-    void test_gen_moves(int max_depth=5);
+    void set_search_limits(const SearchLimits& _limits) { limits = _limits; }
+    void set_hash_size(int mb) { tt.resize(mb); }
+
+    /**
+     * Run perft on the position, to the depth and with the options given.
+     * @return <tt>false</tt> if the checkpoint file can't be opened, or if it
+     *         is asked for with the statistics, which it does not record.
+     */
+    bool test_gen_moves(const PerftOptions& options);
+
+    /**
+     * Run perft on every position of an EPD file, to the depths given by its
+     * ";D<depth> <nodes>" operations, and compare with the expected counts.
+     * @return <tt>true</tt> if every count matches.
+     */
+    bool run_suite(const std::string& filename, const PerftOptions& options);
+
+    /**
+     * Search the position to a fixed depth with 1, 2, 4... threads, up to
+     * @p max_threads, and print the time taken and the speedup over one thread.
+     */
+    void bench(int depth, int max_threads);
+    bool customize_style() { return view.customize_style(); }
 private:
+    Board board;
+    View view;
     White white;
     Black black;
     Square start, target;
     Move current_move, last_move;
-    TestResult t_result;
 
     std::wstring SAN;
     char SAN_piece, SAN_file, SAN_rank, SAN_spec_file, SAN_spec_rank, SAN_prom_pc;
@@ -58,14 +86,25 @@ private:
     bool w_turn, capture, q_castle, k_castle, check, checkmate;
     // , w_en_psst, b_en_psst;
 
-    int nb_move, perft_depth;
+    // Set when a command, such as "auto", ends the game
+    bool game_over;
+
+    int nb_move;
+
+    SearchLimits limits;
+    // Kept from one move to the next, so that the search reuses its results
+    TranspositionTable tt;
+    // Summary of the last search, shown with the move it played
+    std::wstring search_info;
+    // Keys of the positions of the game, to detect repetitions
+    std::vector<uint64_t> history;
+    // The moves played, in SAN, for the move history window
+    const std::string moves_file;
     
     void piece_from_fen(char code, char file, int rank);
+    bool stands_on(Player& player, char code, char file, int rank);
 
-    void make_move(Piece* p, Move move, bool w_ply, bool& k_cstl, bool& q_cstl);
-    void unmake_move(Piece* p, Move move, bool w_ply, bool k_cstl, bool q_cstl);
     bool is_move_legal(Piece* p, char trgt_file, int trgt_rank, bool w_ply);
-    bool handle_check(Piece* piece, char trgt_file, int trgt_rank, bool capt, bool w_p);
     bool process_move(Piece* p, char trgt_file, int trgt_rank, bool w_ply,
                                               char prom_piece, bool test=false);
     bool is_checkmate(bool w_ply);
@@ -73,15 +112,13 @@ private:
 
     void reset_san_variables();
 
-    int divide(int depth, bool w_ply);
-    int compute_moves(int depth=1, bool w_ply=true);
-
-    int search(int depth, int alpha, int beta, bool w_ply);
-    int evaluate(bool w_ply);
-    int count_material(bool w_ply);
-
-    std::vector<Move> generate_moves(bool w_ply);
-    std::vector<Move> generate_legal_moves(bool w_ply);
+    /**
+     * @param w_ply If it's White to play.
+     * @return The position on the board, with the side to move, en passant
+     *         square and castling rights taken from the players.
+     */
+    Position current_position(bool w_ply);
+    void generate_legal_moves(bool w_ply, MoveList& moves);
 };
 
 #endif
@@ -26,26 +26,26 @@
 #include "message.h"
 #include "view.h"
 
-void message::open_moves_win() {
+void message::open_moves_win(const std::string& filename) {
     #ifdef _WIN32
-        system("start pwsh -nop -nol "
-               "-c \"[console]::windowwidth=40; "
-                    "[console]::windowheight=10; "
-                    "[console]::bufferwidth=[console]::windowwidth; " 
-                    "[console]::title='Move History'; "
-                    "gc moves_history.txt -Wait\"");
+        system(("start pwsh -nop -nol "
+                "-c \"[console]::windowwidth=40; "
+                     "[console]::windowheight=10; "
+                     "[console]::bufferwidth=[console]::windowwidth; " 
+                     "[console]::title='Move History'; "
+                     "gc " + filename + " -Wait\"").c_str());
         HWND handle = FindWindow(NULL, "Move History");
         SetWindowPos(handle, NULL, 40, 50, 0, 0, SWP_NOSIZE | SWP_NOZORDER);
     #elif __linux__
-        system("chmod u+x mv_hist && "
-               "gnome-terminal --geometry=60x10+500+400 -- ./mv_hist");
+        system(("chmod u+x mv_hist && "
+                "gnome-terminal --geometry=60x10+500+400 -- ./mv_hist " + filename).c_str());
     #endif
 }
 
-void message::write_to_history(Move move, bool w_ply, int num, bool cap, bool chk,
-                                                           bool chkmt) {
+void message::write_to_history(const std::string& filename, Move move, bool w_ply, int num,
+                               bool cap, bool chk, bool chkmt) {
     std::ofstream log;
-    log.open(moves_history_file, std::ios_base::app);
+    log.open(filename, std::ios_base::app);
     if (w_ply)
         log << num << ". ";
     if (move.piece != 'P' && move.piece != 'p')
@@ -66,9 +66,9 @@ void message::write_to_history(Move move, bool w_ply, int num, bool cap, bool ch
         log << "\n";
 }
 
-void message::erase_history_data() {
+void message::erase_history_data(const std::string& filename) {
     std::ofstream log;
-    log.open(moves_history_file);
+    log.open(filename);
     log << "";
 }
 
@@ -124,6 +124,10 @@ void message::fen_parsing_error() {
     std::wcout << "Error: failed parsing the FEN file: wrong format.\n";
 }
 
+void message::fen_kings_error() {
+    std::wcout << "Error: failed parsing the FEN file: each side needs exactly one king.\n";
+}
+
 void message::fen_file_not_found(std::string filename) {
     #ifdef _WIN32
     std::wcout << "Error: failed opening the file.\n";
@@ -139,3 +143,20 @@ void message::bad_extension(std::string filename) {
     std::cout << "Error: \"" << filename << "\" is not an FEN file.\n";
     #endif
 }
+
+void message::checkpoint_error(std::string filename) {
+    // The standard output is wide oriented by then: narrow output would be lost.
+    std::wcout << "Error: failed opening the checkpoint file \""
+               << std::wstring(filename.begin(), filename.end()) << "\".\n";
+}
+
+void message::checkpoint_line_error(std::string filename, int line) {
+    std::wcout << "Error: malformed line " << line << " in the checkpoint file \""
+               << std::wstring(filename.begin(), filename.end())
+               << "\", expected \"<key> <depth> <move> <nodes>\".\n";
+}
+
+void message::checkpoint_stats_error() {
+    std::wcout << "Error: --stats can't be used with --checkpoint, which only records the"
+                  " counts of the moves.\n";
+}
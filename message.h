@@ -5,10 +5,12 @@
 #include "common.h"
 
 namespace message {
+    // The default file of the moves of a game
     const std::string moves_history_file("moves_history.txt");
-    void open_moves_win();
-    void write_to_history(Move move, bool w_ply, int num, bool cap, bool chk, bool chkmt);
-    void erase_history_data();
+    void open_moves_win(const std::string& filename);
+    void write_to_history(const std::string& filename, Move move, bool w_ply, int num,
+                          bool cap, bool chk, bool chkmt);
+    void erase_history_data(const std::string& filename);
 
     // Game flow messages
     void illegal_move(std::wstring move);
@@ -30,8 +32,14 @@ namespace message {
 
     // FEN file errors
     void fen_parsing_error();
+    void fen_kings_error();
     void fen_file_not_found(std::string filename);
     void bad_extension(std::string filename);
+
+    // Perft errors
+    void checkpoint_error(std::string filename);
+    void checkpoint_line_error(std::string filename, int line);
+    void checkpoint_stats_error();
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,125 @@
+/*
+ * move.cc
+ * This file is part of chess, a console chess engine.
+ * Copyright (C) 2023 Cyprien Lacassagne
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <string>
+#include "move.h"
+
+bool MoveList::contains(PackedMove move) const {
+    for (auto m : *this) {
+        if (m == move)
+            return true;
+    }
+    return false;
+}
+
+PackedMove pack_move(const Move& move, Bitboard ep_sqrs) {
+    int from(square_index(move.start.file, move.start.rank));
+    int to(square_index(move.target.file, move.target.rank));
+    PieceType pt(code_type(move.piece));
+
+    if (move.prom != blank)
+        return PackedMove(from, to, PackedMove::PROMOTION, code_type(move.prom));
+    if (pt == KING && (move.target.file - move.start.file == 2
+                       || move.start.file - move.target.file == 2))
+        return PackedMove(from, to, PackedMove::CASTLING);
+    if (pt == PAWN && move.target.file != move.start.file && (ep_sqrs & square_bb(to)))
+        return PackedMove(from, to, PackedMove::EN_PASSANT);
+    return PackedMove(from, to);
+}
+
+Move unpack_move(PackedMove move, const Position& pos) {
+    return Move(pos.piece_on(move.from()), to_square(move.from()), to_square(move.to()),
+                move.prom_code());
+}
+
+std::wstring to_coordinate(PackedMove move) {
+    std::wstring str;
+    str += square_file(move.from());
+    str += std::to_wstring(square_rank(move.from()));
+    str += square_file(move.to());
+    str += std::to_wstring(square_rank(move.to()));
+    if (move.type() == PackedMove::PROMOTION)
+        str += move.prom_code();
+    return str;
+}
+
+PackedMove from_coordinate(const std::wstring& str, const MoveList& legal) {
+    for (auto move : legal) {
+        if (to_coordinate(move) == str)
+            return move;
+    }
+    return PackedMove::none();
+}
+
+std::wstring to_san(PackedMove move, const Position& pos,
+                    const MoveList& legal) {
+    Square start(to_square(move.from()));
+    Square target(to_square(move.to()));
+    if (move.type() == PackedMove::CASTLING)
+        return (target.file == 'g' ? L"O-O" : L"O-O-O");
+
+    char code(pos.piece_on(move.from()));
+    PieceType pt(code_type(code));
+    bool capture(!pos.is_empty(move.to()) || move.type() == PackedMove::EN_PASSANT);
+    std::wstring san;
+
+    if (pt == PAWN) {
+        if (capture)
+            san += start.file;
+    }else {
+        san += piece_code(WHITE, pt);
+        // Another piece of the same kind may reach the target square.
+        bool ambiguous(false), same_file(false), same_rank(false);
+        for (auto other : legal) {
+            if (other.to() != move.to() || other.from() == move.from()
+                || pos.piece_on(other.from()) != code)
+                continue;
+            ambiguous = true;
+            if (square_file(other.from()) == start.file)
+                same_file = true;
+            if (square_rank(other.from()) == start.rank)
+                same_rank = true;
+        }
+        if (ambiguous && (!same_file || same_rank))
+            san += start.file;
+        if (ambiguous && same_file)
+            san += std::to_wstring(start.rank);
+    }
+
+    if (capture)
+        san += 'x';
+    san += target.file;
+    san += std::to_wstring(target.rank);
+    if (move.type() == PackedMove::PROMOTION) {
+        san += '=';
+        san += piece_code(WHITE, move.prom_type());
+    }
+    return san;
+}
+
+PackedMove from_san(std::wstring san, const Position& pos,
+                    const MoveList& legal) {
+    while (!san.empty() && (san.back() == '+' || san.back() == '#'))
+        san.pop_back();
+    for (auto move : legal) {
+        if (to_san(move, pos, legal) == san)
+            return move;
+    }
+    return PackedMove::none();
+}
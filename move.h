@@ -0,0 +1,111 @@
+#ifndef MOVE_H
+#define MOVE_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include "common.h"
+#include "bitboard.h"
+#include "position.h"
+
+/*
+ * A move packed in 16 bits:
+ *   bits  0-5   start square
+ *   bits  6-11  target square
+ *   bits 12-13  promotion piece, from knight (0) to queen (3)
+ *   bits 14-15  move type
+ * The moving piece and the captured one are read from the position.
+ */
+class PackedMove {
+public:
+    enum Type { NORMAL, PROMOTION, EN_PASSANT, CASTLING };
+
+    // Left uninitialised, so that a move list does not clear its whole capacity.
+    PackedMove() = default;
+    PackedMove(int from, int to, Type type = NORMAL, PieceType prom = KNIGHT)
+    :   data(uint16_t(from | to << 6 | (prom - KNIGHT) << 12 | type << 14)) {}
+
+    int from() const { return data & 0x3F; }
+    int to() const { return (data >> 6) & 0x3F; }
+    Type type() const { return Type(data >> 14); }
+    PieceType prom_type() const { return PieceType(((data >> 12) & 0x3) + KNIGHT); }
+
+    /* Lower case code of the promotion piece, or blank if it's not a promotion */
+    char prom_code() const {
+        return (type() == PROMOTION ? piece_code(BLACK, prom_type()) : blank);
+    }
+
+    /* The null move, which stands for no move at all */
+    static PackedMove none() { return PackedMove(0, 0); }
+    static PackedMove from_raw(uint16_t raw) {
+        PackedMove move;
+        move.data = raw;
+        return move;
+    }
+    bool is_none() const { return data == 0; }
+    uint16_t raw() const { return data; }
+
+    bool operator==(PackedMove other) const { return data == other.data; }
+    bool operator!=(PackedMove other) const { return data != other.data; }
+
+private:
+    uint16_t data;
+};
+
+/*
+ * Fixed-capacity list of moves, meant to live on the stack of the caller.
+ * No position has more than 218 legal moves, so it never overflows.
+ */
+class MoveList {
+public:
+    static constexpr size_t capacity = 256;
+
+    MoveList() : count(0) {}
+
+    void push_back(PackedMove move) { moves[count++] = move; }
+    void clear() { count = 0; }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    PackedMove operator[](size_t i) const { return moves[i]; }
+    PackedMove& operator[](size_t i) { return moves[i]; }
+    bool contains(PackedMove move) const;
+
+    const PackedMove* begin() const { return moves; }
+    const PackedMove* end() const { return moves + count; }
+
+private:
+    PackedMove moves[capacity];
+    size_t count;
+};
+
+/**
+ * @param move The move in coordinate form.
+ * @param ep_sqrs The squares that can be captured en passant.
+ * @return The packed move.
+ */
+PackedMove pack_move(const Move& move, Bitboard ep_sqrs);
+
+/**
+ * @param move The packed move.
+ * @param pos The position before the move.
+ * @return The move in coordinate form.
+ */
+Move unpack_move(PackedMove move, const Position& pos);
+
+/* Coordinate notation, such as "e2e4" or "e7e8q" */
+std::wstring to_coordinate(PackedMove move);
+PackedMove from_coordinate(const std::wstring& str, const MoveList& legal);
+
+/**
+ * @param move The packed move.
+ * @param pos The position before the move.
+ * @param legal The legal moves of the position, to disambiguate the piece.
+ * @return The move in Standard Algebraic Notation, without check indication.
+ */
+std::wstring to_san(PackedMove move, const Position& pos,
+                    const MoveList& legal);
+PackedMove from_san(std::wstring san, const Position& pos,
+                    const MoveList& legal);
+
+#endif
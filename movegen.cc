@@ -0,0 +1,403 @@
+/*
+ * movegen.cc
+ * This file is part of chess, a console chess engine.
+ * Copyright (C) 2023 Cyprien Lacassagne
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "movegen.h"
+
+namespace {
+    struct Castling {
+        CastlingRight right;
+        int king_from;
+        int king_to;
+        Bitboard path;      // Squares that must be empty
+        Bitboard king_path; // Squares that must not be attacked
+    };
+
+    /*
+     * Moves emitted by the generator: every legal move, the captures and
+     * promotions only, or the other moves only
+     */
+    enum GenType { LEGAL, CAPTURES, QUIETS };
+
+    constexpr Castling castlings[2][2] = {
+        {{WHITE_OO, 4, 6, 0x60ULL, 0x60ULL},
+         {WHITE_OOO, 4, 2, 0x0EULL, 0x0CULL}},
+        {{BLACK_OO, 60, 62, 0x60ULL << 56, 0x60ULL << 56},
+         {BLACK_OOO, 60, 58, 0x0EULL << 56, 0x0CULL << 56}}
+    };
+
+    /*
+     * Stands for a move list when the moves are only counted: the targets of
+     * a piece are counted at once, without listing the moves.
+     */
+    struct MoveCount {
+        int n;
+
+        void push_back(PackedMove) { ++n; }
+        void clear() { n = 0; }
+    };
+
+    void add_moves(MoveList& moves, int from, Bitboard targets) {
+        while (targets)
+            moves.push_back(PackedMove(from, pop_lsb(targets)));
+    }
+
+    void add_moves(MoveCount& moves, int, Bitboard targets) {
+        moves.n += popcount(targets);
+    }
+
+    /**
+     * @param targets The squares the pieces may move to, pins aside.
+     * @param pinned The pinned friendly pieces, which stay on their pin line.
+     */
+    template<PieceType Pt, class List>
+    void add_piece_moves(const Position& pos, Bitboard targets, Bitboard pinned, int ksq,
+                         List& moves) {
+        for (Bitboard b(pos.pieces(pos.side_to_move(), Pt)); b; ) {
+            int from(pop_lsb(b));
+            Bitboard t(bitboard::attacks<Pt>(from, pos.pieces()) & targets);
+            if (pinned & square_bb(from))
+                t &= bitboard::line(ksq, from);
+            add_moves(moves, from, t);
+        }
+    }
+
+    /**
+     * Promotions come in four moves, one per piece.
+     * @tparam Step The step of the pawns, from their start to their target.
+     */
+    template<int Step>
+    void add_pawn_moves(MoveList& moves, Bitboard targets) {
+        while (targets) {
+            int to(pop_lsb(targets));
+            if (square_bb(to) & (rank_1_bb | rank_8_bb)) {
+                for (PieceType prom : {QUEEN, ROOK, BISHOP, KNIGHT})
+                    moves.push_back(PackedMove(to - Step, to, PackedMove::PROMOTION, prom));
+            }else
+                moves.push_back(PackedMove(to - Step, to));
+        }
+    }
+
+    template<int Step>
+    void add_pawn_moves(MoveCount& moves, Bitboard targets) {
+        moves.n += popcount(targets) + 3 * popcount(targets & (rank_1_bb | rank_8_bb));
+    }
+
+    /**
+     * @return The friendly pieces that are the only blocker between their king
+     *         and an enemy slider.
+     */
+    template<Color Us>
+    Bitboard pinned_pieces(const Position& pos, int ksq) {
+        constexpr Color them(!Us);
+        Bitboard snipers((bitboard::rook_attacks(ksq, 0)
+                          & (pos.pieces(them, ROOK) | pos.pieces(them, QUEEN)))
+                         | (bitboard::bishop_attacks(ksq, 0)
+                          & (pos.pieces(them, BISHOP) | pos.pieces(them, QUEEN))));
+        Bitboard pinned(0);
+        while (snipers) {
+            Bitboard blockers(bitboard::between(ksq, pop_lsb(snipers)) & pos.pieces());
+            if (popcount(blockers) == 1)
+                pinned |= blockers & pos.pieces(Us);
+        }
+        return pinned;
+    }
+
+    /*
+     * Removing two pawns from the same rank can uncover the king, which the
+     * pins do not catch: such a capture is played on the bitboards and tested.
+     */
+    template<Color Us>
+    bool en_passant_is_legal(const Position& pos, int from, int to, int ksq) {
+        int captured(to - pawn_push(Us));
+        Bitboard occupied((pos.pieces() ^ square_bb(from) ^ square_bb(captured))
+                          | square_bb(to));
+        return !(pos.attackers_to(ksq, occupied) & pos.pieces(!Us) & ~square_bb(captured));
+    }
+
+    /**
+     * The pawns that are not pinned are moved all at once, by shifting their
+     * set. The pinned ones stay on the line of their king. Among the pushes,
+     * the captures only keep those that promote, the quiets those that do not.
+     */
+    template<Color Us, GenType Type, class List>
+    void generate_pawn_moves(const Position& pos, Bitboard check_mask, Bitboard pinned,
+                             int ksq, List& moves) {
+        constexpr int up(pawn_push(Us));
+        constexpr int up_west(up - 1), up_east(up + 1);
+        constexpr Bitboard third_rank(rank_bb(Us == WHITE ? 3 : 6));
+        constexpr Bitboard push_targets(Type == LEGAL    ? ~Bitboard(0)
+                                        : Type == CAPTURES ? rank_1_bb | rank_8_bb
+                                                           : ~(rank_1_bb | rank_8_bb));
+        Bitboard empty(~pos.pieces());
+        Bitboard enemy(pos.pieces(!Us));
+        Bitboard pawns(pos.pieces(Us, PAWN));
+
+        Bitboard free(pawns & ~pinned);
+        Bitboard push(shift<up>(free) & empty & push_targets);
+        Bitboard double_push(shift<up>(push & third_rank) & empty);
+        add_pawn_moves<up>(moves, push & check_mask);
+        add_pawn_moves<2 * up>(moves, double_push & check_mask);
+        if (Type != QUIETS) {
+            add_pawn_moves<up_west>(moves, shift<up_west>(free) & enemy & check_mask);
+            add_pawn_moves<up_east>(moves, shift<up_east>(free) & enemy & check_mask);
+        }
+
+        for (Bitboard b(pawns & pinned); b; ) {
+            int from(pop_lsb(b));
+            Bitboard line(bitboard::line(ksq, from) & check_mask);
+            Bitboard single(shift<up>(square_bb(from)) & empty & push_targets);
+            add_pawn_moves<up>(moves, single & line);
+            add_pawn_moves<2 * up>(moves, shift<up>(single & third_rank) & empty & line);
+            if (Type != QUIETS) {
+                add_pawn_moves<up_west>(moves, shift<up_west>(square_bb(from)) & enemy & line);
+                add_pawn_moves<up_east>(moves, shift<up_east>(square_bb(from)) & enemy & line);
+            }
+        }
+
+        int ep(pos.ep_square());
+        if (Type == QUIETS || ep == no_square)
+            return;
+        for (Bitboard b(bitboard::pawn_attacks(!Us, ep) & pawns); b; ) {
+            int from(pop_lsb(b));
+            if (en_passant_is_legal<Us>(pos, from, ep, ksq))
+                moves.push_back(PackedMove(from, ep, PackedMove::EN_PASSANT));
+        }
+    }
+
+    template<Color Us>
+    Bitboard checkers_of(const Position& pos) {
+        return pos.attackers_to(pos.king_square(Us), pos.pieces()) & pos.pieces(!Us);
+    }
+
+    /**
+     * @tparam Us The side to move.
+     * @tparam Type Every legal move, the captures and promotions only, or the
+     *              other moves only.
+     * @tparam List A MoveList, or a MoveCount to count the moves only.
+     * @param pos The position.
+     * @param map The attack map of the position, or nullptr.
+     * @param moves The list to fill.
+     */
+    template<Color Us, GenType Type, class List>
+    void generate(const Position& pos, const AttackMap* map, List& moves) {
+        moves.clear();
+
+        Bitboard friendly(pos.pieces(Us));
+        Bitboard enemy(pos.pieces(!Us));
+        // Squares a move may land on, checks and pins aside
+        Bitboard occupied(pos.pieces());
+        Bitboard landing(Type == LEGAL ? ~friendly : Type == CAPTURES ? enemy : ~occupied);
+        int ksq(pos.king_square(Us));
+        Bitboard checks(checkers_of<Us>(pos));
+
+        // Squares attacked by the enemy, seen through the king. Without an
+        // attack map, only the squares the king could step on are tested.
+        Bitboard danger(0);
+        if (map) {
+            danger = map->attacks(!Us);
+            for (Bitboard b(checks & ~pos.pieces(PAWN) & ~pos.pieces(KNIGHT)); b; ) {
+                int sq(pop_lsb(b));
+                danger |= bitboard::attacks(pos.type_on(sq), sq, occupied ^ square_bb(ksq));
+            }
+        }else {
+            Bitboard tested(bitboard::king_attacks(ksq) & landing);
+            if (Type != CAPTURES && !checks) {
+                for (const Castling& c : castlings[Us])
+                    tested |= (pos.can_castle(c.right) ? c.king_path : 0);
+            }
+            while (tested) {
+                int sq(pop_lsb(tested));
+                if (pos.attackers_to(sq, occupied ^ square_bb(ksq)) & enemy)
+                    danger |= square_bb(sq);
+            }
+        }
+
+        add_moves(moves, ksq, bitboard::king_attacks(ksq) & landing & ~danger);
+
+        // Only the king can escape a double check.
+        if (popcount(checks) > 1)
+            return;
+
+        // Squares that capture the checker or block its ray.
+        Bitboard check_mask(checks ? bitboard::between(ksq, lsb(checks)) | checks
+                                   : ~Bitboard(0));
+        Bitboard pinned(pinned_pieces<Us>(pos, ksq));
+
+        if (Type != CAPTURES && !checks) {
+            for (const Castling& c : castlings[Us]) {
+                if (!pos.can_castle(c.right) || (occupied & c.path))
+                    continue;
+                if (!(danger & c.king_path))
+                    moves.push_back(PackedMove(c.king_from, c.king_to, PackedMove::CASTLING));
+            }
+        }
+
+        Bitboard targets(landing & check_mask);
+        add_piece_moves<KNIGHT>(pos, targets, pinned, ksq, moves);
+        add_piece_moves<BISHOP>(pos, targets, pinned, ksq, moves);
+        add_piece_moves<ROOK>(pos, targets, pinned, ksq, moves);
+        add_piece_moves<QUEEN>(pos, targets, pinned, ksq, moves);
+        generate_pawn_moves<Us, Type>(pos, check_mask, pinned, ksq, moves);
+    }
+
+}
+
+Bitboard movegen::checkers(const Position& pos) {
+    return (pos.side_to_move() == WHITE ? checkers_of<WHITE>(pos) : checkers_of<BLACK>(pos));
+}
+
+template<Color Us>
+void movegen::generate_legal(const Position& pos, MoveList& moves) {
+    generate<Us, LEGAL>(pos, nullptr, moves);
+}
+
+template void movegen::generate_legal<WHITE>(const Position& pos, MoveList& moves);
+template void movegen::generate_legal<BLACK>(const Position& pos, MoveList& moves);
+
+void movegen::generate_legal(const Position& pos, MoveList& moves) {
+    if (pos.side_to_move() == WHITE)
+        generate<WHITE, LEGAL>(pos, nullptr, moves);
+    else
+        generate<BLACK, LEGAL>(pos, nullptr, moves);
+}
+
+void movegen::generate_legal(const Position& pos, const AttackMap& map, MoveList& moves) {
+    if (pos.side_to_move() == WHITE)
+        generate<WHITE, LEGAL>(pos, &map, moves);
+    else
+        generate<BLACK, LEGAL>(pos, &map, moves);
+}
+
+template<Color Us>
+int movegen::count_legal(const Position& pos) {
+    MoveCount count;
+    generate<Us, LEGAL>(pos, nullptr, count);
+    return count.n;
+}
+
+template int movegen::count_legal<WHITE>(const Position& pos);
+template int movegen::count_legal<BLACK>(const Position& pos);
+
+int movegen::count_legal(const Position& pos) {
+    return (pos.side_to_move() == WHITE ? count_legal<WHITE>(pos) : count_legal<BLACK>(pos));
+}
+
+int movegen::count_legal(const Position& pos, const AttackMap& map) {
+    MoveCount count;
+    if (pos.side_to_move() == WHITE)
+        generate<WHITE, LEGAL>(pos, &map, count);
+    else
+        generate<BLACK, LEGAL>(pos, &map, count);
+    return count.n;
+}
+
+template<Color Us>
+void movegen::generate_captures(const Position& pos, MoveList& moves) {
+    generate<Us, CAPTURES>(pos, nullptr, moves);
+}
+
+template void movegen::generate_captures<WHITE>(const Position& pos, MoveList& moves);
+template void movegen::generate_captures<BLACK>(const Position& pos, MoveList& moves);
+
+void movegen::generate_captures(const Position& pos, MoveList& moves) {
+    if (pos.side_to_move() == WHITE)
+        generate<WHITE, CAPTURES>(pos, nullptr, moves);
+    else
+        generate<BLACK, CAPTURES>(pos, nullptr, moves);
+}
+
+template<Color Us>
+void movegen::generate_quiets(const Position& pos, MoveList& moves) {
+    generate<Us, QUIETS>(pos, nullptr, moves);
+}
+
+template void movegen::generate_quiets<WHITE>(const Position& pos, MoveList& moves);
+template void movegen::generate_quiets<BLACK>(const Position& pos, MoveList& moves);
+
+void movegen::generate_quiets(const Position& pos, MoveList& moves) {
+    if (pos.side_to_move() == WHITE)
+        generate<WHITE, QUIETS>(pos, nullptr, moves);
+    else
+        generate<BLACK, QUIETS>(pos, nullptr, moves);
+}
+
+/*
+ * The move must be one the generator could emit: its piece can make it,
+ * by its rules, and it is then played on a copy to see that the king is
+ * safe.
+ */
+template<Color Us>
+bool movegen::is_legal(const Position& pos, PackedMove move) {
+    int from(move.from()), to(move.to());
+    Bitboard occupied(pos.pieces());
+    if (!(pos.pieces(Us) & square_bb(from)) || (pos.pieces(Us) & square_bb(to)))
+        return false;
+    PieceType pt(pos.type_on(from));
+
+    if (move.type() == PackedMove::CASTLING) {
+        if (checkers_of<Us>(pos))
+            return false;
+        for (const Castling& c : castlings[Us]) {
+            if (from != c.king_from || to != c.king_to || !pos.can_castle(c.right)
+                || (occupied & c.path))
+                continue;
+            for (Bitboard b(c.king_path); b; ) {
+                if (pos.attackers_to(pop_lsb(b), occupied) & pos.pieces(!Us))
+                    return false;
+            }
+            return move == PackedMove(from, to, PackedMove::CASTLING);
+        }
+        return false;
+    }
+    if (move.type() == PackedMove::EN_PASSANT)
+        return pt == PAWN && to == pos.ep_square()
+            && (bitboard::pawn_attacks(Us, from) & square_bb(to))
+            && move == PackedMove(from, to, PackedMove::EN_PASSANT)
+            && en_passant_is_legal<Us>(pos, from, to, pos.king_square(Us));
+
+    // A pawn reaching its last rank must promote, and only then.
+    bool promotes(pt == PAWN && (square_bb(to) & (rank_1_bb | rank_8_bb)));
+    if (promotes != (move.type() == PackedMove::PROMOTION)
+        || (!promotes && move != PackedMove(from, to)))
+        return false;
+
+    Bitboard targets;
+    if (pt == PAWN) {
+        constexpr int up(pawn_push(Us));
+        constexpr Bitboard third_rank(rank_bb(Us == WHITE ? 3 : 6));
+        Bitboard single(shift<up>(square_bb(from)) & ~occupied);
+        targets = single | (shift<up>(single & third_rank) & ~occupied)
+                | (bitboard::pawn_attacks(Us, from) & pos.pieces(!Us));
+    }else
+        targets = bitboard::attacks(pt, from, occupied);
+    if (!(targets & square_bb(to)))
+        return false;
+
+    Position next(pos);
+    next.do_move<Us>(move);
+    return !next.in_check(Us);
+}
+
+template bool movegen::is_legal<WHITE>(const Position& pos, PackedMove move);
+template bool movegen::is_legal<BLACK>(const Position& pos, PackedMove move);
+
+bool movegen::is_legal(const Position& pos, PackedMove move) {
+    return (pos.side_to_move() == WHITE ? is_legal<WHITE>(pos, move)
+                                        : is_legal<BLACK>(pos, move));
+}
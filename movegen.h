@@ -0,0 +1,91 @@
+#ifndef MOVEGEN_H
+#define MOVEGEN_H
+
+#include "position.h"
+#include "move.h"
+#include "attackmap.h"
+
+/*
+ * Legal move generation. The pinned pieces and the squares that resolve a
+ * check are computed once per position, so that only legal moves are emitted
+ * and no move has to be played to be tested.
+ */
+namespace movegen {
+    /**
+     * @param pos The position, with its side to move, en passant square and
+     *            castling rights.
+     * @param moves The list to fill. It is cleared first.
+     */
+    void generate_legal(const Position& pos, MoveList& moves);
+
+    /* Same as above, for a side to move known at compile time */
+    template<Color Us>
+    void generate_legal(const Position& pos, MoveList& moves);
+
+    /**
+     * Same as above, with the enemy attacks read from the attack map of the
+     * position instead of being computed.
+     */
+    void generate_legal(const Position& pos, const AttackMap& map, MoveList& moves);
+
+    /**
+     * Count the legal moves without listing them: the targets of a piece are
+     * counted at once.
+     * @param pos The position, as for generate_legal().
+     * @return The number of legal moves.
+     */
+    int count_legal(const Position& pos);
+
+    /* Same as above, for a side to move known at compile time */
+    template<Color Us>
+    int count_legal(const Position& pos);
+
+    /* Same as above, with the enemy attacks read from the attack map */
+    int count_legal(const Position& pos, const AttackMap& map);
+
+    /**
+     * Generate the legal captures, en passant included, and promotions only,
+     * for the quiescence search. Quiet moves and castles are skipped, evasions
+     * included.
+     * @param pos The position, as for generate_legal().
+     * @param moves The list to fill. It is cleared first.
+     */
+    void generate_captures(const Position& pos, MoveList& moves);
+
+    /* Same as above, for a side to move known at compile time */
+    template<Color Us>
+    void generate_captures(const Position& pos, MoveList& moves);
+
+    /**
+     * Generate the legal moves generate_captures() skips: the quiet moves,
+     * castles included, and the pushes that do not promote.
+     * @param pos The position, as for generate_legal().
+     * @param moves The list to fill. It is cleared first.
+     */
+    void generate_quiets(const Position& pos, MoveList& moves);
+
+    /* Same as above, for a side to move known at compile time */
+    template<Color Us>
+    void generate_quiets(const Position& pos, MoveList& moves);
+
+    /**
+     * Test a move that may come from another position, such as the move of a
+     * transposition table entry, without generating the moves.
+     * @param pos The position.
+     * @param move The move to test.
+     * @return If generate_legal() would emit the move.
+     */
+    bool is_legal(const Position& pos, PackedMove move);
+
+    /* Same as above, for a side to move known at compile time */
+    template<Color Us>
+    bool is_legal(const Position& pos, PackedMove move);
+
+    /**
+     * @param pos The position.
+     * @return The enemy pieces giving check to the side to move.
+     */
+    Bitboard checkers(const Position& pos);
+}
+
+#endif
@@ -0,0 +1,166 @@
+/*
+ * movepick.cc
+ * This file is part of chess, a console chess engine.
+ * Copyright (C) 2023 Cyprien Lacassagne
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <utility>
+#include "movepick.h"
+#include "movegen.h"
+
+namespace {
+    // Scores of the kinds of moves, each above every score of the next one
+    constexpr int capture_score(1 << 29);
+    constexpr int killer_score(1 << 28);
+
+    bool is_capture(const Position& pos, PackedMove move) {
+        return move.type() == PackedMove::EN_PASSANT || !pos.is_empty(move.to());
+    }
+
+    /*
+     * The victim counts first, the attacker breaks the ties. A promotion
+     * adds the value of its piece, as if it captured it.
+     */
+    int mvv_lva(const Position& pos, PackedMove move) {
+        int score(0);
+        if (move.type() == PackedMove::EN_PASSANT)
+            score = 8 * (PAWN + 1);
+        else if (!pos.is_empty(move.to()))
+            score = 8 * (pos.type_on(move.to()) + 1);
+        if (move.type() == PackedMove::PROMOTION)
+            score += 8 * move.prom_type();
+        return score - pos.type_on(move.from());
+    }
+}
+
+void HistoryTable::clear() {
+    for (auto& side : table) {
+        for (auto& from : side) {
+            for (auto& score : from)
+                score = 0;
+        }
+    }
+}
+
+void HistoryTable::update(Color c, PackedMove move, int depth) {
+    int& score(table[c][move.from()][move.to()]);
+    score += depth * depth;
+    // Halving every score keeps them in range, and lets the old ones fade.
+    if (score >= max_score) {
+        for (auto& side : table) {
+            for (auto& from : side) {
+                for (auto& s : from)
+                    s /= 2;
+            }
+        }
+    }
+}
+
+MovePicker::MovePicker(const Position& _pos, PackedMove _tt_move, const PackedMove* _killers,
+                       const HistoryTable& _history)
+:   pos(_pos), history(_history), tt_move(_tt_move), killers(_killers), stage(TT_MOVE),
+    quiets(true), current(0)
+{
+    if (tt_move.is_none() || !movegen::is_legal(pos, tt_move)) {
+        tt_move = PackedMove::none();
+        stage = GEN_CAPTURES;
+    }
+}
+
+MovePicker::MovePicker(const Position& _pos, bool in_check, const HistoryTable& _history)
+:   pos(_pos), history(_history), tt_move(PackedMove::none()), killers(nullptr),
+    stage(in_check ? GEN_EVASIONS : GEN_CAPTURES), quiets(false), current(0)
+{}
+
+/*
+ * Every move of a stage is scored, the captures above the quiets so that the
+ * evasions, which mix both, are ordered too.
+ */
+void MovePicker::score() {
+    for (size_t i(0); i < moves.size(); ++i) {
+        PackedMove move(moves[i]);
+        if (is_capture(pos, move)
+            || (move.type() == PackedMove::PROMOTION && move.prom_type() == QUEEN))
+            scores[i] = capture_score + mvv_lva(pos, move);
+        else if (killers && move == killers[0])
+            scores[i] = killer_score + 1;
+        else if (killers && move == killers[1])
+            scores[i] = killer_score;
+        else
+            scores[i] = history.score(pos.side_to_move(), move);
+    }
+}
+
+/* The move of the table, already handed out, is skipped. */
+PackedMove MovePicker::pick_best() {
+    while (current < moves.size()) {
+        // One step of a selection sort: the best move left comes to the front.
+        size_t best(current);
+        for (size_t i(current + 1); i < moves.size(); ++i) {
+            if (scores[i] > scores[best])
+                best = i;
+        }
+        std::swap(moves[current], moves[best]);
+        std::swap(scores[current], scores[best]);
+        if (moves[current] != tt_move)
+            return moves[current++];
+        ++current;
+    }
+    return PackedMove::none();
+}
+
+PackedMove MovePicker::next() {
+    PackedMove move;
+    switch (stage) {
+        case TT_MOVE:
+            stage = GEN_CAPTURES;
+            return tt_move;
+        case GEN_CAPTURES:
+            movegen::generate_captures(pos, moves);
+            score();
+            current = 0;
+            stage = CAPTURES;
+            return next();
+        case CAPTURES:
+            move = pick_best();
+            if (!move.is_none())
+                return move;
+            stage = quiets ? GEN_QUIETS : END;
+            return next();
+        case GEN_QUIETS:
+            movegen::generate_quiets(pos, moves);
+            score();
+            current = 0;
+            stage = QUIETS;
+            return next();
+        case GEN_EVASIONS:
+            movegen::generate_legal(pos, moves);
+            score();
+            current = 0;
+            stage = EVASIONS;
+            return next();
+        case QUIETS:
+        case EVASIONS:
+            move = pick_best();
+            if (!move.is_none())
+                return move;
+            stage = END;
+            return PackedMove::none();
+        default:
+            return PackedMove::none();
+    }
+}
@@ -0,0 +1,75 @@
+#ifndef MOVEPICK_H
+#define MOVEPICK_H
+
+#include "position.h"
+#include "move.h"
+
+/*
+ * Butterfly table: how often a quiet move, by its start and target squares,
+ * caused a cutoff. Deeper cutoffs weigh more.
+ */
+class HistoryTable {
+public:
+    HistoryTable() { clear(); }
+
+    void clear();
+    void update(Color c, PackedMove move, int depth);
+    int score(Color c, PackedMove move) const { return table[c][move.from()][move.to()]; }
+
+private:
+    static constexpr int max_score = 1 << 20;
+
+    int table[2][nb_squares][nb_squares];
+};
+
+/*
+ * Hands out the moves of a position best first, so that the cutoffs come
+ * early. The moves come by stages, each generated only once the previous one
+ * is used up: the move of the transposition table, tested without generating
+ * anything, then the captures and promotions by MVV-LVA (most valuable victim
+ * first, least valuable attacker next), then the quiet moves, the killers of
+ * the ply first and the others by history. A cutoff on the move of the table
+ * spares the whole generation, one on a capture spares that of the quiets.
+ *
+ * The moves of a stage are not sorted: each call picks the best of the moves
+ * left, so that no work is spent on those a cutoff leaves unsearched.
+ */
+class MovePicker {
+public:
+    /**
+     * For the main search.
+     * @param tt_move The move of the transposition table, or PackedMove::none().
+     *                It is tested first, as it may come from another position.
+     * @param killers The two killer moves of the ply.
+     */
+    MovePicker(const Position& pos, PackedMove tt_move, const PackedMove* killers,
+               const HistoryTable& history);
+
+    /**
+     * For the quiescence search: the captures and promotions only, or every
+     * evasion, in a single stage, if the side to move is in check.
+     */
+    MovePicker(const Position& pos, bool in_check, const HistoryTable& history);
+
+    /* @return The best move left, or PackedMove::none() once they are all picked. */
+    PackedMove next();
+
+private:
+    enum Stage { TT_MOVE, GEN_CAPTURES, CAPTURES, GEN_QUIETS, QUIETS, GEN_EVASIONS, EVASIONS,
+                 END };
+
+    const Position& pos;
+    const HistoryTable& history;
+    PackedMove tt_move;
+    const PackedMove* killers;
+    Stage stage;
+    bool quiets;    // If the quiet moves follow the captures
+    MoveList moves;
+    int scores[MoveList::capacity];
+    size_t current;
+
+    void score();
+    PackedMove pick_best();
+};
+
+#endif
@@ -0,0 +1,280 @@
+/*
+ * perft.cc
+ * This file is part of chess, a console chess engine.
+ * Copyright (C) 2023 Cyprien Lacassagne
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <iostream>
+#include <atomic>
+#include <thread>
+#include <sstream>
+#include "perft.h"
+#include "movegen.h"
+#include "view.h"
+
+TestResult& TestResult::operator+=(const TestResult& other) {
+    n_cptrs += other.n_cptrs;
+    n_ep += other.n_ep;
+    n_cstls += other.n_cstls;
+    n_proms += other.n_proms;
+    n_chks += other.n_chks;
+    n_chkmates += other.n_chkmates;
+    n_atck_updts += other.n_atck_updts;
+    n_atck_skips += other.n_atck_skips;
+    n_probes += other.n_probes;
+    n_hits += other.n_hits;
+    n_hashed += other.n_hashed;
+    return *this;
+}
+
+PerftTable::PerftTable(int mb) {
+    size_t n_entries(1);
+    while (n_entries * 2 * sizeof(Entry) <= (size_t(mb) << 20))
+        n_entries *= 2;
+    entries = std::vector<Entry>(n_entries);
+    mask = n_entries - 1;
+}
+
+bool PerftTable::probe(uint64_t key, int depth, uint64_t& n_nodes) const {
+    const Entry& e(entries[key & mask]);
+    uint64_t data(e.data.load(std::memory_order_relaxed));
+    if ((e.check.load(std::memory_order_relaxed) ^ data) != key || int(data & 0xFF) != depth)
+        return false;
+    n_nodes = data >> 8;
+    return true;
+}
+
+void PerftTable::store(uint64_t key, int depth, uint64_t n_nodes) {
+    Entry& e(entries[key & mask]);
+    uint64_t data(n_nodes << 8 | uint64_t(depth));
+    e.check.store(key ^ data, std::memory_order_relaxed);
+    e.data.store(data, std::memory_order_relaxed);
+}
+
+Checkpoint::Checkpoint(const std::string& filename)
+:   bad_line(0)
+{
+    std::ifstream previous(filename);
+    std::string line;
+    for (int n_line(1); std::getline(previous, line); ++n_line) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        std::istringstream fields(line);
+        uint64_t key, n_nodes;
+        int depth;
+        unsigned move;
+        std::string extra;
+        // The counts past a bad line can't be trusted: the file is not used.
+        if (!(fields >> std::hex >> key >> std::dec >> depth >> move >> n_nodes)
+            || depth < 1 || move > 0xFFFF || (fields >> extra)) {
+            bad_line = n_line;
+            return;
+        }
+        counts[Entry(key, depth, uint16_t(move))] = n_nodes;
+    }
+    previous.close();
+    file.open(filename, std::ios::app);
+}
+
+bool Checkpoint::find(uint64_t key, int depth, PackedMove move, uint64_t& n_nodes) const {
+    auto it(counts.find(Entry(key, depth, move.raw())));
+    if (it == counts.end())
+        return false;
+    n_nodes = it->second;
+    return true;
+}
+
+void Checkpoint::record(uint64_t key, int depth, PackedMove move, uint64_t n_nodes) {
+    std::lock_guard<std::mutex> guard(lock);
+    // Flushed at once, so that a killed run loses no finished move.
+    file << std::hex << key << std::dec << ' ' << depth << ' ' << move.raw() << ' '
+         << n_nodes << std::endl;
+}
+
+Perft::Perft(const Position& root, PerftTable* _table, bool _stats)
+:   table(_table), stats(_stats) {
+    stack[0] = root;
+    map.init(root);
+    clear_result();
+}
+
+void Perft::clear_result() {
+    t_result = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+}
+
+uint64_t Perft::count(PackedMove move, int depth) {
+    stack[1] = stack[0];
+    stack[1].do_move(move);
+    if (depth == 1) {
+        if (stats)
+            updt_test_result(stack[0], move, stack[1]);
+        return 1;
+    }
+    AttackMap::Undo undo;
+    updt_attack_map(stack, move, undo);
+    Position* next(stack + 1);
+    uint64_t n_nodes;
+    if (next->side_to_move() == WHITE)
+        n_nodes = (stats ? compute_moves<WHITE, true>(next, depth-1)
+                         : compute_moves<WHITE, false>(next, depth-1));
+    else
+        n_nodes = (stats ? compute_moves<BLACK, true>(next, depth-1)
+                         : compute_moves<BLACK, false>(next, depth-1));
+    restore_attack_map(undo);
+    return n_nodes;
+}
+
+template<Color Us, bool Stats>
+uint64_t Perft::compute_moves(Position* pos, int depth) {
+
+    uint64_t n_positions(0);
+    if constexpr (Stats) {
+        if (depth == 0)
+            return 1;
+    }else if (table && depth > 1) {
+        // The statistics of the leaves are not stored, so only bulk counts are.
+        ++t_result.n_probes;
+        if (table->probe(pos->key(), depth, n_positions)) {
+            ++t_result.n_hits;
+            t_result.n_hashed += n_positions;
+            return n_positions;
+        }
+    }
+    // Without statistics, the leaves need not be played: they are counted in bulk.
+    if constexpr (!Stats) {
+        if (depth == 1) {
+#ifdef ATTACK_MAP
+            return movegen::count_legal(*pos, map);
+#else
+            return movegen::count_legal<Us>(*pos);
+#endif // ATTACK_MAP
+        }
+    }
+    MoveList moves;
+#ifdef ATTACK_MAP
+    movegen::generate_legal(*pos, map, moves);
+#else
+    movegen::generate_legal<Us>(*pos, moves);
+#endif // ATTACK_MAP
+
+    for (auto move : moves) {
+        // The next entry of the stack receives the position after the move.
+        // Nothing has to be undone afterwards.
+        pos[1] = pos[0];
+        pos[1].do_move<Us>(move);
+        if constexpr (Stats) {
+            if (depth == 1)
+                updt_test_result(pos[0], move, pos[1]);
+        }
+        // The leaves do not generate moves, so they need no attack map.
+        if (depth > 1) {
+            AttackMap::Undo undo;
+            updt_attack_map(pos, move, undo);
+            n_positions += compute_moves<!Us, Stats>(pos + 1, depth-1);
+            restore_attack_map(undo);
+        }else
+            n_positions += compute_moves<!Us, Stats>(pos + 1, depth-1);
+    }
+    if constexpr (!Stats) {
+        if (table)
+            table->store(pos->key(), depth, n_positions);
+    }
+
+    return n_positions;
+}
+
+void Perft::updt_attack_map(const Position* pos, PackedMove move, AttackMap::Undo& undo) {
+#ifdef ATTACK_MAP
+    int n_updts(map.update(pos[0], move, pos[1], undo));
+    Bitboard sliders(pos[1].pieces(BISHOP) | pos[1].pieces(ROOK) | pos[1].pieces(QUEEN));
+    t_result.n_atck_updts += n_updts;
+    t_result.n_atck_skips += popcount(sliders) - n_updts;
+#endif // ATTACK_MAP
+}
+
+void Perft::restore_attack_map(const AttackMap::Undo& undo) {
+#ifdef ATTACK_MAP
+    map.restore(undo);
+#endif // ATTACK_MAP
+}
+
+void Perft::updt_test_result(const Position& pos, PackedMove move, const Position& next) {
+    if (move.type() == PackedMove::EN_PASSANT) {
+        ++t_result.n_cptrs;
+        ++t_result.n_ep;
+    }else if (!pos.is_empty(move.to()))
+        ++t_result.n_cptrs;
+    if (move.type() == PackedMove::CASTLING)
+        ++t_result.n_cstls;
+    if (move.type() == PackedMove::PROMOTION)
+        ++t_result.n_proms;
+
+    if (movegen::checkers(next)) {
+        ++t_result.n_chks;
+        if (movegen::count_legal(next) == 0)
+            ++t_result.n_chkmates;
+    }
+}
+
+size_t perft::run(const MoveList& moves, int depth, std::vector<Perft>& workers,
+                  Checkpoint* checkpoint, std::vector<uint64_t>& counts,
+                  std::vector<uint64_t>& nodes, bool progress) {
+    counts.assign(moves.size(), 0);
+    nodes.assign(workers.size(), 0);
+    uint64_t key(workers.front().root_key());
+
+    // Only the moves missing from the checkpoint are explored.
+    std::vector<size_t> todo;
+    for (size_t i(0); i < moves.size(); ++i) {
+        if (!checkpoint || !checkpoint->find(key, depth, moves[i], counts[i]))
+            todo.push_back(i);
+    }
+
+    std::atomic<size_t> next(0);
+    progress = progress && workers.size() == 1;
+
+    auto work = [&](size_t id) {
+        Perft& worker(workers[id]);
+        worker.clear_result();
+        for (size_t j(next++); j < todo.size(); j = next++) {
+            size_t i(todo[j]);
+            if (progress) {
+                std::wcout << restore_cursor_pos << clr_end_line << msg_color
+                           << j + 1 << "/" << todo.size() << "\n";
+                if (j + 1 == todo.size())
+                    std::wcout << restore_cursor_pos << clr_end_line << msg_color;
+            }
+            counts[i] = worker.count(moves[i], depth);
+            nodes[id] += counts[i];
+            if (checkpoint)
+                checkpoint->record(key, depth, moves[i], counts[i]);
+        }
+    };
+
+    if (workers.size() == 1)
+        work(0);
+    else {
+        std::vector<std::thread> threads;
+        for (size_t id(0); id < workers.size(); ++id)
+            threads.emplace_back(work, id);
+        for (auto& t : threads)
+            t.join();
+    }
+    // The speed is that of the move generator: the counts read from the table are left out.
+    for (size_t id(0); id < workers.size(); ++id)
+        nodes[id] -= workers[id].get_result().n_hashed;
+    return moves.size() - todo.size();
+}
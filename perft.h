@@ -0,0 +1,183 @@
+#ifndef PERFT_H
+#define PERFT_H
+
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include <string>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include "common.h"
+#include "position.h"
+#include "move.h"
+#include "attackmap.h"
+
+struct TestResult {
+    uint64_t n_cptrs;
+    uint64_t n_ep;
+    uint64_t n_cstls;
+    uint64_t n_proms;
+    uint64_t n_chks;
+    uint64_t n_chkmates;
+    // Sliders whose attacks were recomputed, or kept, after a move
+    uint64_t n_atck_updts;
+    uint64_t n_atck_skips;
+    // Lookups in the table of subtree counts, and those that found the count
+    uint64_t n_probes;
+    uint64_t n_hits;
+    // Leaves read from the table instead of being counted
+    uint64_t n_hashed;
+
+    TestResult& operator+=(const TestResult& other);
+};
+
+struct PerftOptions {
+    int max_depth = 5;
+    int n_threads = 1;
+    // Size of the table of subtree counts, none if 0
+    int hash_mb = 16;
+    // Print the count of each root move of the last depth
+    bool divide = false;
+    // Play the leaves to count captures, checks, etc. instead of bulk counting
+    bool stats = false;
+    // File recording the counts of the root moves, none if empty
+    std::string checkpoint;
+};
+
+/*
+ * Node counts of the subtrees already explored, indexed by Zobrist key and
+ * depth. The workers of all threads share the table without locking: an
+ * entry stores its key xored with its data, so an entry torn by two threads
+ * writing at once fails the key check and is ignored.
+ */
+class PerftTable {
+public:
+    /* @param mb The size in megabytes, rounded down to a power of two entries. */
+    explicit PerftTable(int mb);
+
+    /**
+     * @param key The Zobrist key of the position.
+     * @param depth The depth of the subtree below the position.
+     * @param n_nodes Receives the count of the subtree, if found.
+     * @return <tt>true</tt> if the count of the subtree was found.
+     */
+    bool probe(uint64_t key, int depth, uint64_t& n_nodes) const;
+    void store(uint64_t key, int depth, uint64_t n_nodes);
+
+    size_t size_mb() const { return entries.size() * sizeof(Entry) >> 20; }
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+    std::vector<Entry> entries;
+    uint64_t mask;
+};
+
+/*
+ * File recording the count of each root move once explored, so that a run
+ * interrupted after hours resumes where it stopped. Each line holds the key
+ * of the root position, the depth, the raw move and its count.
+ */
+class Checkpoint {
+public:
+    /* Load the counts recorded by previous runs, if the file exists. */
+    explicit Checkpoint(const std::string& filename);
+
+    bool is_open() const { return file.is_open(); }
+
+    /* @return The number of the first malformed line of the file, or 0. */
+    int malformed_line() const { return bad_line; }
+
+    /**
+     * @param n_nodes Receives the count of the move, if recorded.
+     * @return <tt>true</tt> if the count of the move was recorded.
+     */
+    bool find(uint64_t key, int depth, PackedMove move, uint64_t& n_nodes) const;
+
+    /* Append the count of a move, from any thread. */
+    void record(uint64_t key, int depth, PackedMove move, uint64_t n_nodes);
+
+private:
+    typedef std::tuple<uint64_t, int, uint16_t> Entry;
+    std::map<Entry, uint64_t> counts;
+    std::ofstream file;
+    std::mutex lock;
+    int bad_line;
+};
+
+/*
+ * Counts the leaves of the move tree below the root moves of a position.
+ * Perft walks a stack of positions: the position after a move is written to
+ * the next entry, so nothing has to be undone. With ATTACK_MAP, an attack map
+ * is also kept up to date and restored once the move is explored.
+ *
+ * The walk is compiled twice: bulk counting, which counts the moves of the
+ * last ply without playing them, and the full statistics, which play every
+ * leaf to classify it. Only the root picks one, so bulk counting pays nothing
+ * for the statistics.
+ *
+ * A worker owns its stack, attack map and counters, so that several of them
+ * can explore different root moves on different threads.
+ */
+class Perft {
+public:
+    /**
+     * @param root The position whose moves are explored.
+     * @param table The table of subtree counts, or nullptr to count every leaf.
+     *              It is not used for the full statistics.
+     * @param stats If the leaves are classified, in the counters of get_result().
+     */
+    Perft(const Position& root, PerftTable* table, bool stats);
+
+    /**
+     * @param move A legal move of the root position.
+     * @param depth The depth of the tree, the root move included.
+     * @return The number of leaves below the move.
+     */
+    uint64_t count(PackedMove move, int depth);
+
+    uint64_t root_key() const { return stack[0].key(); }
+    const TestResult& get_result() const { return t_result; }
+    void clear_result();
+
+private:
+    Position stack[max_ply + 1];
+    AttackMap map;
+    PerftTable* table;
+    bool stats;
+    TestResult t_result;
+
+    template<Color Us, bool Stats>
+    uint64_t compute_moves(Position* pos, int depth);
+    void updt_attack_map(const Position* pos, PackedMove move, AttackMap::Undo& undo);
+    void restore_attack_map(const AttackMap::Undo& undo);
+    void updt_test_result(const Position& pos, PackedMove move, const Position& next);
+};
+
+namespace perft {
+    /**
+     * Explore the root moves with one thread per worker. Each thread takes the
+     * next move nobody explored yet, until there is none left. A single worker
+     * runs on the calling thread, and may show its progress.
+     * @param moves The legal moves of the root position of the workers.
+     * @param depth The depth of the tree, the root moves included.
+     * @param workers The workers, whose counters are cleared first.
+     * @param checkpoint The counts recorded by earlier runs, which are not
+     *                   explored again, or nullptr.
+     * @param counts Filled with the number of leaves below each root move.
+     * @param nodes Filled with the number of leaves counted by each worker,
+     *              those read from the table of subtree counts left out.
+     * @param progress Rewrite the number of root moves explored on a line
+     *                 saved with save_cursor_pos, if there is a single worker.
+     * @return The number of root moves whose count was recorded earlier.
+     */
+    size_t run(const MoveList& moves, int depth, std::vector<Perft>& workers,
+               Checkpoint* checkpoint, std::vector<uint64_t>& counts,
+               std::vector<uint64_t>& nodes, bool progress);
+}
+
+#endif
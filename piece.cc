@@ -20,384 +20,90 @@
 #include <iostream>
 #include <string>
 #include "piece.h"
-#include "board.h"
-
-/************************
- *  PIECE PARENT CLASS  *
- ************************/
-Piece::Piece(char _code, char _file, int _rank)
-    : code(_code), file(_file), rank(_rank), hidden(false) {}
-
-Piece::~Piece() {}
-
-bool Piece::is_elligible_for_move(char SAN_piece, char SAN_file, char SAN_rank,
-                                  char SAN_spec_file, char SAN_spec_rank) const {
-
-    if (SAN_piece != code && SAN_piece != code + upcase_shift) return false;
-    for (auto sq : cov_sqrs) {
-        if (sq.file == SAN_file && sq.rank == SAN_rank - '0') {
-            if ((SAN_spec_file != blank && SAN_spec_file == file) ||
-                (SAN_spec_rank != blank && SAN_spec_rank - '0' == rank))
-                return true;
-            else if (SAN_spec_file == blank && SAN_spec_rank == blank)
-                return true;
+#include "position.h"
+#include "bitboard.h"
+
+namespace {
+    /**
+     * @tparam Pt The type of the piece.
+     * @return The squares the piece can move to, checks and castling aside.
+     */
+    template<PieceType Pt>
+    Bitboard range(const Position& pos, char code, char file, int rank) {
+        if constexpr (Pt == PAWN)
+            return pawn_range(pos, code, file, rank);
+        else {
+            return bitboard::attacks<Pt>(square_index(file, rank), pos.pieces())
+                   & ~pos.pieces(code_color(code));
         }
     }
-    return false;
-}
-
-void Piece::updt_position(char SAN_file, char SAN_rank, bool silent) {
-    file = SAN_file;
-    rank = SAN_rank - '0';
-}
 
-void Piece::updt_position(char SAN_file, int SAN_rank, bool silent) {
-    file = SAN_file;
-    rank = SAN_rank;
-}
-
-bool Piece::attacking_enemy_king() const {
-    for (auto sq : get_atck_sqrs()) {
-        if (is_enemy_king(code, sq.file, sq.rank)) return true;
+    /**
+     * @return The target squares of the king if it castles, provided that its
+     *         side still has the right and the squares between the king and
+     *         the rook are empty.
+     */
+    Bitboard castling_range(const Position& pos, char code, char file, int rank) {
+        Color us(code_color(code));
+        int sq(square_index(file, rank));
+        Bitboard targets(0);
+        if (pos.can_castle(us == WHITE ? WHITE_OOO : BLACK_OOO)
+            && !(pos.pieces() & bitboard::between(sq, sq - 4)))
+            targets |= square_bb(sq - 2);
+        if (pos.can_castle(us == WHITE ? WHITE_OO : BLACK_OO)
+            && !(pos.pieces() & bitboard::between(sq, sq + 3)))
+            targets |= square_bb(sq + 2);
+        return targets;
     }
-    return false;
-}
-
-/**********
- *  KING  *
- **********/
-King::King(char code, char file, int rank)
-    : Piece(code, file, rank), has_moved(file != 'e') {
-    if ((code == 'K' && rank != 1) || (code == 'k' && rank != 8))
-        has_moved = true;
 }
 
-King::~King() {}
-
-void King::updt_cov_sqrs() {
-    cov_sqrs.clear();
-    for (char c(file-1); c <= file+1; ++c) {
-        for (int r(rank-1); r <= rank+1; ++r) {
-            if (c >= 'a' &&  c <= 'h' && r >= 1 && r <= board_size &&
-                !is_friendly(code, c, r)) {
-                cov_sqrs.push_back({c, r});
-            }
-        }
-    }
-    if (!has_moved) {
-        bool free_way(true);
-        for (char f(file-1); f >= char(file-3); --f) {
-            if (!is_empty(f, rank)) {
-                free_way = false;
-                break;
-            }
-        }
-        if (free_way)
-            cov_sqrs.push_back({char(file-2), rank});
-        
-        free_way = true;
+Piece::Piece(char _code, char _file, int _rank)
+    : code(_code), file(_file), rank(_rank), hidden(false), has_moved(false),
+      cov_sqrs(0) {}
 
-        for (char f(file+1); f <= char(file+2); ++f) {
-            if (!is_empty(f, rank)) {
-                free_way = false;
-                break;
-            }
-        }
-        if (free_way)
-            cov_sqrs.push_back({char(file+2), rank});
-        // if (is_empty(char(file-2), rank))
-        //     cov_sqrs.push_back({char(file-2), rank});
-        // if (is_empty(char(file+2), rank))
-        //     cov_sqrs.push_back({char(file+2), rank});
+void Piece::updt_cov_sqrs(const Position& pos) {
+    switch (get_type()) {
+        case PAWN: cov_sqrs = range<PAWN>(pos, code, file, rank); break;
+        case KNIGHT: cov_sqrs = range<KNIGHT>(pos, code, file, rank); break;
+        case BISHOP: cov_sqrs = range<BISHOP>(pos, code, file, rank); break;
+        case ROOK: cov_sqrs = range<ROOK>(pos, code, file, rank); break;
+        case QUEEN: cov_sqrs = range<QUEEN>(pos, code, file, rank); break;
+        case KING:
+            cov_sqrs = range<KING>(pos, code, file, rank) | castling_range(pos, code, file, rank);
+            break;
+        default: cov_sqrs = 0; break;
     }
 }
 
-void King::updt_position(char SAN_file, char SAN_rank, bool silent) {
-    file = SAN_file;
-    rank = SAN_rank - '0';
-    if (!silent)
-        has_moved = true;
-}
-
-void King::updt_position(char SAN_file, int SAN_rank, bool silent) {
-    file = SAN_file;
-    rank = SAN_rank;
-    if (!silent)
-        has_moved = true;
-}
-
-/***********
- *  QUEEN  *
- ***********/
-Queen::Queen(char code, char file, int rank)
-    : Piece(code, file, rank) {}
-
-Queen::~Queen() {}
-
-void Queen::updt_cov_sqrs() {
-    cov_sqrs.clear();
-    rook_range(cov_sqrs, code, file, rank);
-    bishop_range(cov_sqrs, code, file, rank);
-}
-
-/**********
- *  ROOK  *
- **********/
-Rook::Rook(char code, char file, int rank)
-    : Piece(code, file, rank), has_moved(false) {}
-
-Rook::~Rook() {}
-
-void Rook::updt_cov_sqrs() {
-    cov_sqrs.clear();
-    rook_range(cov_sqrs, code, file, rank);
-}
+bool Piece::is_elligible_for_move(char SAN_piece, char SAN_file, char SAN_rank,
+                                  char SAN_spec_file, char SAN_spec_rank) const {
 
-void Rook::updt_position(char SAN_file, char SAN_rank, bool silent) {
-    file = SAN_file;
-    rank = SAN_rank - '0';
-    if (!silent)
-        has_moved = true;
+    if (SAN_piece != code && SAN_piece != code + upcase_shift) return false;
+    if (!(cov_sqrs & square_bb(SAN_file, SAN_rank - '0')))
+        return false;
+    if ((SAN_spec_file != blank && SAN_spec_file == file) ||
+        (SAN_spec_rank != blank && SAN_spec_rank - '0' == rank))
+        return true;
+    return SAN_spec_file == blank && SAN_spec_rank == blank;
 }
 
-void Rook::updt_position(char SAN_file, int SAN_rank, bool silent) {
+void Piece::updt_position(char SAN_file, int SAN_rank, bool silent) {
     file = SAN_file;
     rank = SAN_rank;
     if (!silent)
         has_moved = true;
 }
 
-/************
- *  BISHOP  *
- ************/
-Bishop::Bishop(char code, char file, int rank)
-    : Piece(code, file, rank) {}
-
-Bishop::~Bishop() {}
-
-void Bishop::updt_cov_sqrs() {
-    cov_sqrs.clear();
-    bishop_range(cov_sqrs, code, file, rank);
-}
-
-/************
- *  KNIGHT  *
- ************/
-Knight::Knight(char code, char file, int rank)
-    : Piece(code, file, rank) {}
-
-Knight::~Knight() {}
-
-void Knight::updt_cov_sqrs() {
-    cov_sqrs.clear();
-    if (rank + 2 <= board_size && file + 1 <= 'h' && !is_friendly(code, file+1, rank+2))
-        cov_sqrs.push_back({char(file+1), rank+2});
-    if (rank + 1 <= board_size && file + 2 <= 'h' && !is_friendly(code, file+2, rank+1))
-        cov_sqrs.push_back({char(file+2), rank+1});
-    if (rank - 1 >= 1 && file + 2 <= 'h' && !is_friendly(code, file+2, rank-1))
-        cov_sqrs.push_back({char(file+2), rank-1});
-    if (rank - 2 >= 1 && file + 1 <= 'h' && !is_friendly(code, file+1, rank-2))
-        cov_sqrs.push_back({char(file+1), rank-2});
-    if (rank - 2 >= 1 && file - 1 >= 'a' && !is_friendly(code, file-1, rank-2))
-        cov_sqrs.push_back({char(file-1), rank-2});
-    if (rank - 1 >= 1 && file - 2 >= 'a' && !is_friendly(code, file-2, rank-1))
-        cov_sqrs.push_back({char(file-2), rank-1});
-    if (rank + 1 <= board_size && file - 2 >= 'a' && !is_friendly(code, file-2, rank+1))
-        cov_sqrs.push_back({char(file-2), rank+1});
-    if (rank + 2 <= board_size && file - 1 >= 'a' && !is_friendly(code, file-1, rank+2))
-        cov_sqrs.push_back({char(file-1), rank+2});
-}
-
-/**********
- *  PAWN  *
- **********/
-Pawn::Pawn(char code, char file, int rank)
-    : Piece(code, file, rank), has_moved(false), has_en_passant(false) {}
-
-Pawn::~Pawn() {}
-
-void Pawn::updt_cov_sqrs() {
-    cov_sqrs.clear();
-    int r(rank);
-    bool blocked(false);
-    if (code == 'P')
-        ++r;
-    else
-        --r;
-
-    if (r >= 1 && r <= board_size) {
-        if (is_empty(file, r))
-            cov_sqrs.push_back({file, r});
-        else
-            blocked = true;
-    }
+Bitboard pawn_range(const Position& pos, char code, char file, int rank) {
+    Color us(code_color(code));
+    int sq(square_index(file, rank));
+    // En passant squares lie on the 6th rank for White, the 3rd for Black.
+    int ep(pos.ep_square());
+    Bitboard ep_sqrs(ep == no_square ? 0 : square_bb(ep) & rank_bb(us == WHITE ? 6 : 3));
+    Bitboard targets(bitboard::pawn_attacks(us, sq) & (pos.pieces(!us) | ep_sqrs));
 
-    if (char(file-1) >= 'a') {
-        if (is_enemy(code, char(file-1), r))
-            cov_sqrs.push_back({char(file-1), r});
-        if ((code == 'P' && r == 6) || (code == 'p' && r == 3)) {
-            if (is_en_passant_sqr(char(file-1), r))
-                cov_sqrs.push_back({char(file-1), r});
-        }
-    }
-    if (char(file+1) <= 'h') {
-        if (is_enemy(code, char(file+1), r)) 
-            cov_sqrs.push_back({char(file+1), r});
-        if ((code == 'P' && r == 6) || (code == 'p' && r == 3)) {
-            if (is_en_passant_sqr(char(file+1), r))
-                cov_sqrs.push_back({char(file+1), r});
-        }
-    }
-    if (code == 'P') 
-        ++r;
-    else
-        --r;
-    if (r >= 1 && r <= board_size) {
-        if (code == 'P') {
-            if (rank == 2 && !blocked && is_empty(file, r))
-                cov_sqrs.push_back({file, r});
-        }else if (rank == 7 && !blocked && is_empty(file, r))
-            cov_sqrs.push_back({file, r});
-    }
-}
-
-void Pawn::updt_position(char SAN_file, char SAN_rank, bool silent) {
-    if (!has_moved) {
-        if (code == 'P' && SAN_rank - '0' == rank + 2) {
-            has_en_passant = true;
-            write_en_passant_sqr(file, rank+1);
-        }else if (code == 'p' && SAN_rank - '0' == rank - 2) {
-            has_en_passant = true;
-            write_en_passant_sqr(file, rank-1);
-        }
-    }
-    file = SAN_file;
-    rank = SAN_rank - '0';
-    if (!silent) {
-        has_moved = true;
-    }
+    Bitboard push(bitboard::pawn_pushes(us, sq) & ~pos.pieces());
+    if (push && rank == (us == WHITE ? 2 : 7))
+        push |= bitboard::pawn_pushes(us, lsb(push)) & ~pos.pieces();
+    return targets | push;
 }
-
-void Pawn::updt_position(char SAN_file, int SAN_rank, bool silent) {
-    if (!has_moved) {
-        if (code == 'P' && SAN_rank == rank + 2) {
-            has_en_passant = true;
-            write_en_passant_sqr(file, rank+1);
-        }else if (code == 'p' && SAN_rank == rank - 2) {
-            has_en_passant = true;
-            write_en_passant_sqr(file, rank-1);
-        }
-    }
-    file = SAN_file;
-    rank = SAN_rank;
-    if (!silent) {
-        has_moved = true;
-    }
-}
-
-void Pawn::clear_en_passant() {
-    has_en_passant = false;
-}
-
-std::vector<Square> Pawn::get_atck_sqrs() const {
-    std::vector<Square> attacked_sqrs;
-    for (auto sq : cov_sqrs) {
-        if (sq.file != this->file)
-            attacked_sqrs.push_back({sq.file, sq.rank});
-    }
-    return attacked_sqrs;
-}
-
-void rook_range(std::vector<Square>& covered_sqrs, char code, char file, int rank) {
-    for (char c(file+1); c <= 'h'; ++c) {
-        if (!is_friendly(code, c, rank)) {
-            if (is_enemy(code, c, rank)) {
-                covered_sqrs.push_back({c, rank});
-                break;
-            }else 
-                covered_sqrs.push_back({c, rank});
-        }else break;
-    }
-    for (char c(file-1); c >= 'a'; --c) {
-        if (!is_friendly(code, c, rank)) {
-            if (is_enemy(code, c, rank)) {
-                covered_sqrs.push_back({c, rank});
-                break;
-            }else
-                covered_sqrs.push_back({c, rank});
-        }else break;
-    }
-    for (int r(rank+1); r <= board_size; ++r) {
-        if (!is_friendly(code, file, r)) {
-            if (is_enemy(code, file, r)) {
-                covered_sqrs.push_back({file, r});
-                break;
-            }else
-                covered_sqrs.push_back({file, r});
-        }else break;
-    }
-    for (int r(rank-1); r >= 1; --r) {
-        if (!is_friendly(code, file, r)) {
-            if (is_enemy(code, file, r)) {
-                covered_sqrs.push_back({file, r});
-                break;
-            }else
-                covered_sqrs.push_back({file, r});
-        }else break;
-    }
-}
-
-void bishop_range(std::vector<Square>& covered_sqrs, char code, char file, int rank) {
-    char c1 = file;
-    char c2 = file;
-    int r = rank;
-    for (int i(1); i <= board_size-rank; ++i) {
-        ++c1;
-        ++r;
-        if (c1 <= 'h' && r <= board_size && !is_friendly(code, c1, r)) {
-            if (is_enemy(code, c1, r)) {
-                covered_sqrs.push_back({c1, r});
-                break;
-            }else
-                covered_sqrs.push_back({c1, r});
-        }else break;
-    }
-    r = rank;
-    for (int i(1); i <= board_size-rank; ++i) {
-        --c2;
-        ++r;
-        if (c2 >= 'a' && r <= board_size && !is_friendly(code, c2, r)) {
-            if (is_enemy(code, c2, r)) {
-                covered_sqrs.push_back({c2, r});
-                break;
-            }else
-                covered_sqrs.push_back({c2, r});
-        }else break;
-    }
-    c1 = file;
-    c2 = file;
-    r = rank;
-    for (int i(1); i <= rank; ++i) {
-        ++c1;
-        --r;
-        if (c1 <= 'h' && r >= 1 && !is_friendly(code, c1, r)) {
-            if (is_enemy(code, c1, r)) {
-                covered_sqrs.push_back({c1, r});
-                break;
-            }else
-                covered_sqrs.push_back({c1, r});
-        }else break;
-    }
-    r = rank;
-    for (int i(1); i <= rank; ++i) {
-        --c2;
-        --r;
-        if (c2 >= 'a' && r >= 1 && !is_friendly(code, c2, r)) {
-            if (is_enemy(code, c2, r)) {
-                covered_sqrs.push_back({c2, r});
-                break;
-            }else
-                covered_sqrs.push_back({c2, r});
-        }else break;
-    }
-}
\ No newline at end of file
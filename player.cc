@@ -23,16 +23,17 @@
 #include "board.h"
 #include "message.h"
 
-Piece* Player::unique_piece_for_move(char SAN_piece, char SAN_file, char SAN_rank,
-                                     char SAN_spec_file, char SAN_spec_rank) {
+Piece* Player::unique_piece_for_move(const Position& pos, char SAN_piece, char SAN_file,
+                                     char SAN_rank, char SAN_spec_file,
+                                     char SAN_spec_rank) {
     elligible_pieces.clear();
     for (auto& p : pieces) {
-        if (p->get_hidden())
+        if (p.get_hidden())
             continue;
-        p->updt_cov_sqrs();
-        if (p->is_elligible_for_move(SAN_piece, SAN_file, SAN_rank, 
+        p.updt_cov_sqrs(pos);
+        if (p.is_elligible_for_move(SAN_piece, SAN_file, SAN_rank, 
                                      SAN_spec_file, SAN_spec_rank)) {
-            elligible_pieces.push_back(p);
+            elligible_pieces.push_back(&p);
         }
     }
     if (elligible_pieces.size() == 1)
@@ -47,251 +48,89 @@ Piece* Player::unique_piece_for_move(char SAN_piece, char SAN_file, char SAN_ran
     return nullptr;
 }
 
-Piece* Player::attacker() {
+void Player::write_pieces_on_board(Board& board) {
     for (auto& p : pieces) {
-        if (p->get_hidden())
+        if (p.get_hidden())
             continue;
-        p->updt_cov_sqrs();
-        if (p->attacking_enemy_king())
-            return p;
-    }
-    return nullptr;
-}
-
-void Player::write_pieces_on_board() {
-    for (auto p : pieces) {
-        if (p->get_hidden())
-            continue;
-        write_piece(p->get_code(), p->get_file(), p->get_rank());
-    }
-}
-
-// void Player::new_piece(char code, char file, char rank) {
-//     switch (code) {
-//         case 'B': pieces.push_back(new Bishop(code, file, rank)); break;
-//         case 'K': pieces.push_back(new King(code, file, rank)); break;
-//         case 'N': pieces.push_back(new Knight(code, file, rank)); break;
-//         case 'P': pieces.push_back(new Pawn(code, file, rank)); break;
-//         case 'Q': pieces.push_back(new Queen(code, file, rank)); break;
-//         case 'R': pieces.push_back(new Rook(code, file, rank)); break;
-//         default: std::wcout << "Couldn't add a new piece to a player\n"; break;
-//     }
-// }
-
-void Player::reveal_piece(char file, int rank) {
-    for (auto& p : pieces) {
-        if (p->get_file() == file && p->get_rank() == rank)
-            p->reveal();
+        board.write_piece(p.get_code(), p.get_file(), p.get_rank());
     }
 }
 
 void Player::hide_piece(char file, int rank) {
-    for (auto& p : pieces) {
-        if (p->get_file() == file && p->get_rank() == rank) {
-            p->hide();
-        }
-    }
-}
-
-void Player::piece_captured(char SAN_file, char SAN_rank) {
-    for (size_t i(0); i < pieces.size(); ++i) {
-        if (pieces[i]->get_file() == SAN_file && 
-            pieces[i]->get_rank() == SAN_rank - '0') {
-            last_captured = *pieces[i];
-            delete pieces[i];
-            pieces.erase(pieces.begin() + i);
-            track_pieces();
-            return;
-        }
-    }
-}
-
-void Player::piece_captured(char SAN_file, int SAN_rank) {
-    for (size_t i(0); i < pieces.size(); ++i) {
-        if (pieces[i]->get_file() == SAN_file && 
-            pieces[i]->get_rank() == SAN_rank) {
-            last_captured = *pieces[i];
-            delete pieces[i];
-            pieces.erase(pieces.begin() + i);
-            track_pieces();
-            return;
-        }
-    }
+    int sq(square_index(file, rank));
+    if (by_square[sq] == no_index)
+        return;
+    pieces[by_square[sq]].hide();
+    by_square[sq] = no_index;
+}
+
+void Player::piece_captured(char file, int rank) {
+    int sq(square_index(file, rank));
+    int i(by_square[sq]);
+    if (i == no_index)
+        return;
+    by_square[sq] = no_index;
+    // Fill the hole with the last piece, so that no other index shifts.
+    int last(int(pieces.size()) - 1);
+    if (i != last) {
+        pieces[i] = pieces[last];
+        int last_sq(square_index(pieces[i].get_file(), pieces[i].get_rank()));
+        if (by_square[last_sq] == last)
+            by_square[last_sq] = i;
+    }
+    pieces.pop_back();
 }
 
 void Player::delete_pieces() {
-    for (auto& p : pieces) {
-        delete p;
-    }
     pieces.clear();
+    clear_squares();
 }
 
-void Player::reset_en_passant_sqr() {
-    for (auto& p : pieces) {
-        if (p->get_hidden())
-            continue;
-        p->clear_en_passant();
-    }
-}
-
-bool Player::has_en_passant_sqr() {
-    for (auto p : pieces) {
-        if (p->get_hidden())
-            continue;
-        if (p->get_has_en_psst()) {
-            return true;
-        }
-    }
-    return false;
+void Player::move_piece(Piece* p, char file, int rank, bool silent) {
+    int i(int(p - pieces.data()));
+    int from(square_index(p->get_file(), p->get_rank()));
+    if (by_square[from] == i)
+        by_square[from] = no_index;
+    by_square[square_index(file, rank)] = i;
+    p->updt_position(file, rank, silent);
 }
 
-void Player::track_pieces() {
-
-    tracker.king.clear();
-    tracker.queen.clear();
-    tracker.rook.clear();
-    tracker.bishop.clear();
-    tracker.knight.clear();
-    tracker.pawn.clear();
-
-    for (size_t i(0); i < pieces.size(); ++i) {
-        char code(pieces[i]->get_code());
-        switch (code) {
-            case 'K':
-            case 'k':
-                tracker.king.push_back(i);
-                break;
-            case 'Q':
-            case 'q':
-                tracker.queen.push_back(i);
-                break;
-            case 'R':
-            case 'r':
-                tracker.rook.push_back(i);
-                break;
-            case 'B':
-            case 'b':
-                tracker.bishop.push_back(i);
-                break;
-            case 'N':
-            case 'n':
-                tracker.knight.push_back(i);
-                break;
-            case 'P':
-            case 'p':
-                tracker.pawn.push_back(i);
-                break;
-            default:
-                std::wcout << "Unable to track a piece : " << code << "\n";
-                break;
-        }
-    }
+Piece* Player::piece_at(char file, int rank) {
+    int i(by_square[square_index(file, rank)]);
+    return (i == no_index ? nullptr : &pieces[i]);
 }
 
 Piece* Player::find_piece(char code, char file, int rank) {
-
-    switch (code) {
-        case 'K':
-        case 'k':
-            for (auto i : tracker.king) {
-                if (pieces[i]->get_file() == file && pieces[i]->get_rank() == rank)
-                    return pieces[i];
-            }
-            std::wcout << "no king\n";
-            break;
-        case 'Q':
-        case 'q':
-            for (auto i : tracker.queen) {
-                if (pieces[i]->get_file() == file && pieces[i]->get_rank() == rank)
-                    return pieces[i];
-            }
-            std::wcout << "no queen : " << file << rank << "\n";
-            break;
-        case 'R':
-        case 'r':
-            for (auto i : tracker.rook) {
-                if (pieces[i]->get_file() == file && pieces[i]->get_rank() == rank)
-                    return pieces[i];
-            }
-            std::wcout << "no rook\n";
-            break;
-        case 'B':
-        case 'b':
-            for (auto i : tracker.bishop) {
-                if (pieces[i]->get_file() == file && pieces[i]->get_rank() == rank)
-                    return pieces[i];
-            }
-            std::wcout << "no bishop\n";
-            break;
-        case 'N':
-        case 'n':
-            for (auto i : tracker.knight) {
-                if (pieces[i]->get_file() == file && pieces[i]->get_rank() == rank)
-                    return pieces[i];
-            }
-            std::wcout << "no knight\n";
-            break;
-        case 'P':
-        case 'p':
-            for (auto i : tracker.pawn) {
-                if (pieces[i]->get_file() == file && pieces[i]->get_rank() == rank)
-                    return pieces[i];
-            }
-            std::wcout << "no pawn\n";
-            break;
-        default:
-            std::wcout << "Incorrect piece encoding : " << code << "\n";
-            break;
-    }
+    Piece* p(piece_at(file, rank));
+    if (p && p->get_code() == code)
+        return p;
+    std::wcout << "no piece " << code << " on " << file << rank << "\n";
     return nullptr;
 }
 
-Piece* Player::find_cap_piece(char file, int rank) {
-    for (auto& p : pieces) {
-        if (p->get_file() == file && p->get_rank() == rank)
-            return p;
-    }
-    return nullptr;
+void Player::add_piece(char code, char file, int rank) {
+    by_square[square_index(file, rank)] = int(pieces.size());
+    pieces.push_back(Piece(code, file, rank));
 }
 
-/***********
- *  WHITE  *
- ***********/
-void White::new_piece(char code, char file, int rank) {
-    switch (code) {
-        case 'B': pieces.push_back(new Bishop(code, file, rank)); break;
-        case 'K': pieces.push_back(new King(code, file, rank)); break;
-        case 'N': pieces.push_back(new Knight(code, file, rank)); break;
-        case 'P': pieces.push_back(new Pawn(code, file, rank)); break;
-        case 'Q': pieces.push_back(new Queen(code, file, rank)); break;
-        case 'R': pieces.push_back(new Rook(code, file, rank)); break;
-        default: std::wcout << "Couldn't add a new piece to White\n"; break;
-    }
-    track_pieces();
-}
-
-void White::uprise_last_cap() {
-
-    char nc = last_captured.get_code();
-    char nf = last_captured.get_file();
-    int nr = last_captured.get_rank();
-
-    new_piece(nc, nf, nr);
+void Player::clear_squares() {
+    for (auto& i : by_square)
+        i = no_index;
 }
 
-bool White::king_is_last() {
+bool Player::king_is_last() {
     if (pieces.size() == 1) return true;
     if (pieces.size() > 3) return false;
 
-    for (auto p : pieces) {
-        char c(p->get_code());
-        if (c == 'R' || c == 'Q' || c == 'P')
+    for (auto& p : pieces) {
+        PieceType pt(p.get_type());
+        if (pt == ROOK || pt == QUEEN || pt == PAWN)
             return false;
     }
 
     int bishops(0);
-    for (auto p : pieces) {
-        if (p->get_code() == 'B')
+    for (auto& p : pieces) {
+        if (p.get_type() == BISHOP)
             ++bishops;
     }
     if (bishops >= 1 && pieces.size() > 2) return false;
@@ -299,188 +138,30 @@ bool White::king_is_last() {
     return true;
 }
 
-bool White::can_k_castle() {
-    bool no_rook_on_h1(true);
-    for (auto& p : pieces) {
-        if (p->get_hidden())
-            continue;
-        if (p->get_code() == 'K' && (p->get_has_moved() || p->get_file() != 'e'))
-            return false;
-        if (p->get_code() == 'R' && p->get_file() == 'h' && p->get_rank() == 1) {
-            no_rook_on_h1 = false;
-            if (p->get_has_moved())
-                return false;
-        }
-    }
-    if (no_rook_on_h1)
-        return false;
-
-    return true;
-}
-
-bool White::can_q_castle() {
-    bool no_rook_on_a1(true);
-    for (auto& p : pieces) {
-        if (p->get_hidden())
-            continue;
-        if (p->get_code() == 'K' && (p->get_has_moved() || p->get_file() != 'e'))
-            return false;
-        if (p->get_code() == 'R' && p->get_file() == 'a' && p->get_rank() == 1) {
-            no_rook_on_a1 = false;
-            if (p->get_has_moved())
-                return false;
-        }
-    }
-    if (no_rook_on_a1)
-        return false;
-
-    return true;
-}
-
-void White::castle_king_side(bool silent) {
-    for (auto& p : pieces) {
-        if (p->get_code() == 'K')
-            silent ? p->updt_position('g', 1, true) : p->updt_position('g', 1);
-        if (p->get_code() == 'R' && p->get_file() == 'h' && p->get_rank() == 1) {
-            silent ? p->updt_position('f', 1, true) : p->updt_position('f', 1);
-        }
-    }
-}
-
-void White::castle_queen_side(bool silent) {
-    for (auto& p : pieces) {
-        if (p->get_code() == 'K')
-            silent ? p->updt_position('c', 1, true) : p->updt_position('c', 1);
-        if (p->get_code() == 'R' && p->get_file() == 'a' && p->get_rank() == 1)
-            silent ? p->updt_position('d', 1, true) : p->updt_position('d', 1);
-    }
-}
-
-void White::undo_k_castle(bool silent) {
-    for (auto& p : pieces) {
-        if (p->get_code() == 'R' && p->get_file() == 'f' && p->get_rank() == 1)
-            silent ? p->updt_position('h', 1, true) : p->updt_position('h', 1);
-    }
-}
-
-void White::undo_q_castle(bool silent) {
-    for (auto& p : pieces) {
-        if (p->get_code() == 'R' && p->get_file() == 'd' && p->get_rank() == 1)
-            silent ? p->updt_position('a', 1, true) : p->updt_position('a', 1);
-    }
-}
-
 /***********
- *  BLACK  *
+ *  SIDES  *
  ***********/
-void Black::new_piece(char code, char file, int rank) {
-    switch (code) {
-        case 'b': pieces.push_back(new Bishop(code, file, rank)); break;
-        case 'k': pieces.push_back(new King(code, file, rank)); break;
-        case 'n': pieces.push_back(new Knight(code, file, rank)); break;
-        case 'p': pieces.push_back(new Pawn(code, file, rank)); break;
-        case 'q': pieces.push_back(new Queen(code, file, rank)); break;
-        case 'r': pieces.push_back(new Rook(code, file, rank)); break;
-        default: std::wcout << "Couldn't add a new piece to Black\n"; break;
+template<Color Us>
+void Side<Us>::new_piece(char code, char file, int rank) {
+    if (code_type(code) == NO_PIECE_TYPE || code_color(code) != Us) {
+        std::wcout << "Couldn't add a new piece to " << (Us == WHITE ? "White" : "Black")
+                   << "\n";
+        return;
     }
+    add_piece(code, file, rank);
 }
 
-void Black::uprise_last_cap() {
-
-    char nc(last_captured.get_code());
-    char nf(last_captured.get_file());
-    int nr(last_captured.get_rank());
-
-    new_piece(nc, nf, nr);
+template<Color Us>
+void Side<Us>::castle_king_side(bool silent) {
+    if (Piece* rook = piece_at('h', home_rank))
+        move_piece(rook, 'f', home_rank, silent);
 }
 
-bool Black::king_is_last() {
-    if (pieces.size() == 1) return true;
-    if (pieces.size() > 3) return false;
-
-    for (auto p : pieces) {
-        char c(p->get_code());
-        if (c == 'r' || c == 'q' || c == 'p')
-            return false;
-    }
-
-    int bishops(0);
-    for (auto p : pieces) {
-        if (p->get_code() == 'b')
-            ++bishops;
-    }
-    if (bishops >= 1 && pieces.size() > 2) return false;
-
-    return true;
+template<Color Us>
+void Side<Us>::castle_queen_side(bool silent) {
+    if (Piece* rook = piece_at('a', home_rank))
+        move_piece(rook, 'd', home_rank, silent);
 }
 
-bool Black::can_k_castle() {
-    bool no_rook_on_h8(true);
-    for (auto& p : pieces) {
-        if (p->get_hidden())
-            continue;
-        if (p->get_code() == 'k' && (p->get_has_moved() || p->get_file() != 'e'))
-            return false;
-        if (p->get_code() == 'r' && p->get_file() == 'h' && p->get_rank() == 8) {
-            no_rook_on_h8 = false;
-            if (p->get_has_moved())
-                return false;
-        }
-    }
-    if (no_rook_on_h8)
-        return false;
-
-    return true;
-}
-
-bool Black::can_q_castle() {
-    bool no_rook_on_a8(true);
-    for (auto& p : pieces) {
-        if (p->get_hidden())
-            continue;
-        if (p->get_code() == 'k' && (p->get_has_moved() || p->get_file() != 'e')) 
-            return false;
-        if (p->get_code() == 'r' && p->get_file() == 'a' && p->get_rank() == 8) {
-            no_rook_on_a8 = false;
-            if (p->get_has_moved())
-                return false;
-        }
-    }
-    if (no_rook_on_a8)
-        return false;
-
-    return true;
-}
-
-void Black::castle_king_side(bool silent) {
-    for (auto& p : pieces) {
-        if (p->get_code() == 'k')
-            silent ? p->updt_position('g', 8, true) : p->updt_position('g', 8);
-        if (p->get_code() == 'r' && p->get_file() == 'h' && p->get_rank() == 8) {
-            silent ? p->updt_position('f', 8, true) : p->updt_position('f', 8);
-        }
-    }
-}
-
-void Black::castle_queen_side(bool silent) {
-    for (auto& p : pieces) {
-        if (p->get_code() == 'k')
-            silent ? p->updt_position('c', 8, true) : p->updt_position('c', 8);
-        if (p->get_code() == 'r' && p->get_file() == 'a' && p->get_rank() == 8)
-            silent ? p->updt_position('d', 8, true) : p->updt_position('d', 8);
-    }
-}
-
-void Black::undo_k_castle(bool silent) {
-    for (auto& p : pieces) {
-        if (p->get_code() == 'r' && p->get_file() == 'f' && p->get_rank() == 8)
-            silent ? p->updt_position('h', 8, true) : p->updt_position('h', 8);
-    }
-}
-
-void Black::undo_q_castle(bool silent) {
-    for (auto& p : pieces) {
-        if (p->get_code() == 'r' && p->get_file() == 'd' && p->get_rank() == 8)
-            silent ? p->updt_position('a', 8, true) : p->updt_position('a', 8);
-    }
-}
\ No newline at end of file
+template class Side<WHITE>;
+template class Side<BLACK>;
@@ -6,93 +6,79 @@
 #include <string>
 #include "piece.h"
 #include "common.h"
+#include "board.h"
 
 class Player {
 public:
-    Player() { reset_en_passant_sqr(); }
-    virtual ~Player() { delete_pieces(); }
+    Player() { clear_squares(); }
+    virtual ~Player() {}
 
-    Piece* unique_piece_for_move(char SAN_piece, char SAN_col, char SAN_rank, 
-                                 char SAN_spec_file, char SAN_spec_rank);
-    Piece* attacker();
+    Piece* unique_piece_for_move(const Position& pos, char SAN_piece, char SAN_col,
+                                 char SAN_rank, char SAN_spec_file, char SAN_spec_rank);
 
-    void write_pieces_on_board();
-    // void new_piece(char code, char file, char rank);
-    void reveal_piece(char file, int rank);
+    void write_pieces_on_board(Board& board);
     void hide_piece(char file, int rank);
-    void piece_captured(char file, char rank);
     void piece_captured(char file, int rank);
     void delete_pieces();
 
-    void reset_en_passant_sqr();
-    bool has_en_passant_sqr();
-
-    void track_pieces();
+    /**
+     * Move one of the player's pieces and keep the square index in sync.
+     * @param p The piece, which must belong to the player.
+     * @param file The target file.
+     * @param rank The target rank.
+     * @param silent If <tt>true</tt>, the piece is not marked as moved.
+     */
+    void move_piece(Piece* p, char file, int rank, bool silent=false);
+
+    /**
+     * @return The visible piece of the player standing on the square,
+     *         or <tt>nullptr</tt> if there is none.
+     */
+    Piece* piece_at(char file, int rank);
     Piece* find_piece(char code, char file, int rank);
-    Piece* find_cap_piece(char file, int rank);
 
     virtual void new_piece(char code, char file, int rank) = 0;
 
-    virtual void uprise_last_cap() = 0;
-    virtual bool king_is_last() = 0;
+    /* If the pieces left cannot mate */
+    bool king_is_last();
 
-    virtual bool can_k_castle() = 0;
-    virtual bool can_q_castle() = 0;
+    /* The king is moved by the caller, these only make the rook jump over it */
     virtual void castle_king_side(bool silent=false) = 0;
     virtual void castle_queen_side(bool silent=false) = 0;
-    virtual void undo_k_castle(bool silent=false) = 0;
-    virtual void undo_q_castle(bool silent=false) = 0;
 
-    Piece* get_piece(size_t i) { return pieces[i]; }
+    Piece* get_piece(size_t i) { return &pieces[i]; }
     Army* get_pieces() { return &pieces; }
     size_t get_nb_pieces() const { return pieces.size(); }
 
 protected:
+    void add_piece(char code, char file, int rank);
 
-    struct PieceTracker {
-        std::vector<size_t> king;
-        std::vector<size_t> queen;
-        std::vector<size_t> rook;
-        std::vector<size_t> bishop;
-        std::vector<size_t> knight;
-        std::vector<size_t> pawn;
-    };
-
-    PieceTracker tracker;
-    Army pieces, elligible_pieces;
-    Piece last_captured;
-};
+    Army pieces;
+    std::vector<Piece*> elligible_pieces;
 
-class White : public Player {
-public:
-    White() {}
-    virtual ~White() {}
-    void new_piece(char code, char file, int rank) override;
-    void uprise_last_cap() override;
-    bool king_is_last() override;
-    bool can_k_castle() override;
-    bool can_q_castle() override;
-    void castle_king_side(bool silent=false) override;
-    void castle_queen_side(bool silent=false) override;
-    void undo_k_castle(bool silent=false) override;
-    void undo_q_castle(bool silent=false) override;
 private:
+    void clear_squares();
+
+    // Index in the army of the piece standing on each square, or no_index.
+    static constexpr int no_index = -1;
+    int by_square[nb_squares];
 };
 
-class Black : public Player {
+/*
+ * The pieces of one side. The color is a template parameter, so that both
+ * sides share one implementation.
+ */
+template<Color Us>
+class Side : public Player {
 public:
-    Black() {}
-    virtual ~Black() {}
     void new_piece(char code, char file, int rank) override;
-    void uprise_last_cap() override;
-    bool king_is_last() override;
-    bool can_k_castle() override;
-    bool can_q_castle() override;
     void castle_king_side(bool silent=false) override;
     void castle_queen_side(bool silent=false) override;
-    void undo_k_castle(bool silent=false) override;
-    void undo_q_castle(bool silent=false) override;
 private:
+    static constexpr int home_rank = (Us == WHITE ? 1 : board_size);
 };
 
+typedef Side<WHITE> White;
+typedef Side<BLACK> Black;
+
 #endif
\ No newline at end of file
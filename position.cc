@@ -0,0 +1,187 @@
+/*
+ * position.cc
+ * This file is part of chess, a console chess engine.
+ * Copyright (C) 2023 Cyprien Lacassagne
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "position.h"
+#include "move.h"
+
+namespace {
+    /*
+     * Castling rights kept when a piece leaves or lands on a square: moving
+     * the king or a rook, or capturing a rook, loses the matching rights.
+     */
+    constexpr std::array<int, nb_squares> make_castling_masks() {
+        std::array<int, nb_squares> masks{};
+        for (int sq(0); sq < nb_squares; ++sq)
+            masks[sq] = WHITE_OO | WHITE_OOO | BLACK_OO | BLACK_OOO;
+        masks[0] &= ~WHITE_OOO;
+        masks[4] &= ~(WHITE_OO | WHITE_OOO);
+        masks[7] &= ~WHITE_OO;
+        masks[56] &= ~BLACK_OOO;
+        masks[60] &= ~(BLACK_OO | BLACK_OOO);
+        masks[63] &= ~BLACK_OO;
+        return masks;
+    }
+
+    constexpr std::array<int, nb_squares> castling_masks(make_castling_masks());
+}
+
+void Position::clear() {
+    for (auto& b : by_type)
+        b = 0;
+    by_color[WHITE] = by_color[BLACK] = 0;
+    for (auto& pt : board)
+        pt = NO_PIECE_TYPE;
+    king_sq[WHITE] = king_sq[BLACK] = no_square;
+    side = WHITE;
+    ep_sqr = no_square;
+    castling = NO_CASTLING;
+    hash = zobrist::state(side, ep_sqr, castling);
+}
+
+void Position::set_state(Color _side, int ep, int rights) {
+    hash ^= zobrist::state(side, ep_sqr, castling) ^ zobrist::state(_side, ep, rights);
+    side = _side;
+    ep_sqr = ep;
+    castling = rights;
+}
+
+void Position::put_piece(char code, int sq) {
+    PieceType pt(code_type(code));
+    if (pt == NO_PIECE_TYPE)
+        return;
+    remove_piece(sq);
+    by_type[pt] |= square_bb(sq);
+    by_color[code_color(code)] |= square_bb(sq);
+    board[sq] = pt;
+    hash ^= zobrist::piece(code_color(code), pt, sq);
+    if (pt == KING)
+        king_sq[code_color(code)] = sq;
+}
+
+void Position::remove_piece(int sq) {
+    if (board[sq] == NO_PIECE_TYPE)
+        return;
+    Color c(by_color[WHITE] & square_bb(sq) ? WHITE : BLACK);
+    hash ^= zobrist::piece(c, type_on(sq), sq);
+    if (board[sq] == KING)
+        king_sq[c] = no_square;
+    Bitboard mask(~square_bb(sq));
+    for (auto& b : by_type)
+        b &= mask;
+    by_color[WHITE] &= mask;
+    by_color[BLACK] &= mask;
+    board[sq] = NO_PIECE_TYPE;
+}
+
+char Position::piece_on(int sq) const {
+    PieceType pt(type_on(sq));
+    if (pt == NO_PIECE_TYPE)
+        return '.';
+    return piece_code(by_color[WHITE] & square_bb(sq) ? WHITE : BLACK, pt);
+}
+
+template<Color Us>
+void Position::do_move(PackedMove move) {
+    constexpr Color them(!Us);
+    int from(move.from());
+    int to(move.to());
+    PieceType pt(type_on(from));
+    Bitboard from_to(square_bb(from) | square_bb(to));
+
+    int captured(move.type() == PackedMove::EN_PASSANT ? to - pawn_push(Us) : to);
+    if (by_color[them] & square_bb(captured)) {
+        hash ^= zobrist::piece(them, type_on(captured), captured);
+        by_type[type_on(captured)] ^= square_bb(captured);
+        by_color[them] ^= square_bb(captured);
+        board[captured] = NO_PIECE_TYPE;
+    }
+
+    by_type[pt] ^= from_to;
+    by_color[Us] ^= from_to;
+    board[from] = NO_PIECE_TYPE;
+    board[to] = pt;
+    hash ^= zobrist::piece(Us, pt, from) ^ zobrist::piece(Us, pt, to);
+    if (pt == KING)
+        king_sq[Us] = to;
+
+    if (move.type() == PackedMove::PROMOTION) {
+        by_type[PAWN] ^= square_bb(to);
+        by_type[move.prom_type()] ^= square_bb(to);
+        board[to] = move.prom_type();
+        hash ^= zobrist::piece(Us, PAWN, to) ^ zobrist::piece(Us, move.prom_type(), to);
+    }else if (move.type() == PackedMove::CASTLING) {
+        // The rook jumps over the king, from the corner next to its target.
+        bool king_side(to > from);
+        int rook_from(king_side ? to + 1 : to - 2);
+        int rook_to(king_side ? to - 1 : to + 1);
+        by_type[ROOK] ^= square_bb(rook_from) | square_bb(rook_to);
+        by_color[Us] ^= square_bb(rook_from) | square_bb(rook_to);
+        board[rook_from] = NO_PIECE_TYPE;
+        board[rook_to] = ROOK;
+        hash ^= zobrist::piece(Us, ROOK, rook_from) ^ zobrist::piece(Us, ROOK, rook_to);
+    }
+
+    update_state(from, to, pt == PAWN && (to ^ from) == 2 * board_size);
+}
+
+template void Position::do_move<WHITE>(PackedMove move);
+template void Position::do_move<BLACK>(PackedMove move);
+
+void Position::do_move(PackedMove move) {
+    side == WHITE ? do_move<WHITE>(move) : do_move<BLACK>(move);
+}
+
+void Position::update_state(int from, int to, bool double_push) {
+    set_state(!side, (double_push ? (from + to) / 2 : no_square),
+              castling & castling_masks[from] & castling_masks[to]);
+}
+
+Bitboard Position::attacks_from(char code, int sq) const {
+    PieceType pt(code_type(code));
+    if (pt == PAWN)
+        return bitboard::pawn_attacks(code_color(code), sq);
+    return bitboard::attacks(pt, sq, pieces());
+}
+
+Bitboard Position::attackers_to(int sq, Bitboard occupied) const {
+    return (bitboard::pawn_attacks(BLACK, sq) & pieces(WHITE, PAWN))
+         | (bitboard::pawn_attacks(WHITE, sq) & pieces(BLACK, PAWN))
+         | (bitboard::knight_attacks(sq) & pieces(KNIGHT))
+         | (bitboard::bishop_attacks(sq, occupied) & (pieces(BISHOP) | pieces(QUEEN)))
+         | (bitboard::rook_attacks(sq, occupied) & (pieces(ROOK) | pieces(QUEEN)))
+         | (bitboard::king_attacks(sq) & pieces(KING));
+}
+
+bool Position::is_square_attacked(int sq, Color by) const {
+    Bitboard occupied(pieces());
+    Bitboard enemy(pieces(by));
+    return (bitboard::pawn_attacks(!by, sq) & by_type[PAWN] & enemy)
+        || (bitboard::knight_attacks(sq) & by_type[KNIGHT] & enemy)
+        || (bitboard::king_attacks(sq) & by_type[KING] & enemy)
+        || (bitboard::bishop_attacks(sq, occupied) & (by_type[BISHOP] | by_type[QUEEN]) & enemy)
+        || (bitboard::rook_attacks(sq, occupied) & (by_type[ROOK] | by_type[QUEEN]) & enemy);
+}
+
+Chessboard Position::to_chessboard() const {
+    Chessboard chessboard;
+    // The grid is stored rank by rank, from the h-file to the a-file.
+    for (int sq(0); sq < nb_squares; ++sq)
+        chessboard[sq / board_size][board_size - 1 - sq % board_size] = piece_on(sq);
+    return chessboard;
+}
@@ -0,0 +1,186 @@
+#ifndef POSITION_H
+#define POSITION_H
+
+#include <cstdint>
+#include <type_traits>
+#include "common.h"
+#include "bitboard.h"
+
+class PackedMove;
+
+/* Deepest line that perft and the search can explore */
+constexpr int max_ply(128);
+
+enum CastlingRight {
+    NO_CASTLING,
+    WHITE_OO = 1,
+    WHITE_OOO = 2,
+    BLACK_OO = 4,
+    BLACK_OOO = 8
+};
+
+/*
+ * Zobrist keys: a position is hashed by xoring one random key per piece on
+ * its square, plus keys for the castling rights, the file of the en passant
+ * square and the side to move. The keys are drawn at compile time.
+ */
+namespace zobrist {
+    struct Keys {
+        uint64_t psq[2][nb_piece_types][nb_squares];
+        uint64_t castling[16];
+        uint64_t ep_file[board_size];
+        uint64_t side;
+    };
+
+    constexpr Keys make_keys() {
+        Keys keys{};
+        // xorshift64*, the same generator as the one searching the magics
+        uint64_t s(1070372);
+        auto rand = [&s]() {
+            s ^= s >> 12;
+            s ^= s << 25;
+            s ^= s >> 27;
+            return s * 2685821657736338717ULL;
+        };
+        for (auto& color : keys.psq) {
+            for (auto& type : color) {
+                for (auto& key : type)
+                    key = rand();
+            }
+        }
+        // Each right has its own key, a set of rights is the xor of them.
+        uint64_t rights[4] = {rand(), rand(), rand(), rand()};
+        for (int i(0); i < 16; ++i) {
+            for (int right(0); right < 4; ++right) {
+                if (i & (1 << right))
+                    keys.castling[i] ^= rights[right];
+            }
+        }
+        for (auto& key : keys.ep_file)
+            key = rand();
+        keys.side = rand();
+        return keys;
+    }
+
+    inline constexpr Keys keys(make_keys());
+
+    inline uint64_t piece(Color c, PieceType pt, int sq) { return keys.psq[c][pt][sq]; }
+
+    /* Key of the side to move, en passant square and castling rights */
+    inline uint64_t state(Color side, int ep, int rights) {
+        return (side == BLACK ? keys.side : 0) ^ keys.castling[rights]
+             ^ (ep == no_square ? 0 : keys.ep_file[ep % board_size]);
+    }
+}
+
+/*
+ * Piece placement stored as one bitboard per piece type and one per color.
+ * The pieces of a given color and type are the intersection of both sets.
+ * A mailbox gives the type of the piece standing on a square in one load.
+ *
+ * A position is small and trivially copyable: moves are played on a copy
+ * pushed on a per-ply stack, and taking a move back is just going back to
+ * the previous entry.
+ */
+class Position {
+public:
+    Position() { clear(); }
+
+    void clear();
+    void put_piece(char code, int sq);
+    void remove_piece(int sq);
+
+    /**
+     * @param side The side to move.
+     * @param ep The square that can be captured en passant, or no_square.
+     * @param rights The castling rights, as a combination of CastlingRight.
+     */
+    void set_state(Color side, int ep, int rights);
+
+    /**
+     * Play a legal move and hand the turn to the other side.
+     * @tparam Us The side to move, so that its branches fold at compile time.
+     * @param move The move, generated for this position.
+     */
+    template<Color Us>
+    void do_move(PackedMove move);
+    void do_move(PackedMove move);
+
+    /**
+     * Update the castling rights and the en passant square after a move, and
+     * hand the turn to the other side. The pieces are not touched.
+     * @param from The start square of the move.
+     * @param to The target square of the move.
+     * @param double_push If the move is a pawn pushed by two squares.
+     */
+    void update_state(int from, int to, bool double_push);
+
+    Color side_to_move() const { return side; }
+    int ep_square() const { return ep_sqr; }
+    bool can_castle(int right) const { return castling & right; }
+    int castling_rights() const { return castling; }
+    /* Zobrist key, kept up to date by every change of the position */
+    uint64_t key() const { return hash; }
+
+    /**
+     * @param sq The square's index.
+     * @return The code of the piece standing on the square, or '.' if it is empty.
+     */
+    char piece_on(int sq) const;
+    PieceType type_on(int sq) const { return PieceType(board[sq]); }
+    bool is_empty(int sq) const { return !(pieces() & square_bb(sq)); }
+
+    Bitboard pieces() const { return by_color[WHITE] | by_color[BLACK]; }
+    Bitboard pieces(Color c) const { return by_color[c]; }
+    Bitboard pieces(PieceType pt) const { return by_type[pt]; }
+    Bitboard pieces(Color c, PieceType pt) const { return by_color[c] & by_type[pt]; }
+
+    /**
+     * @param code The code of the piece.
+     * @param sq The square the piece stands on.
+     * @return The squares attacked by the piece, friendly ones included.
+     */
+    Bitboard attacks_from(char code, int sq) const;
+
+    /**
+     * @param sq The square's index.
+     * @param occupied The squares blocking the sliding pieces.
+     * @return The pieces of both sides attacking the square.
+     */
+    Bitboard attackers_to(int sq, Bitboard occupied) const;
+
+    /**
+     * Look outward from the square for an attacker, leapers first, and stop
+     * at the first one found.
+     * @param sq The square's index.
+     * @param by The attacking side.
+     * @return <tt>true</tt> if a piece of @p by attacks the square.
+     */
+    bool is_square_attacked(int sq, Color by) const;
+
+    /* The square of the king, or no_square if the side has none */
+    int king_square(Color c) const { return king_sq[c]; }
+    bool in_check(Color c) const {
+        return king_sq[c] != no_square && is_square_attacked(king_sq[c], !c);
+    }
+
+    int count(Color c, PieceType pt) const { return popcount(pieces(c, pt)); }
+    int count() const { return popcount(pieces()); }
+
+    Chessboard to_chessboard() const;
+
+private:
+    Bitboard by_type[nb_piece_types];
+    Bitboard by_color[2];
+    uint8_t board[nb_squares];
+    int king_sq[2];
+    Color side;
+    int ep_sqr;
+    int castling;
+    uint64_t hash;
+};
+
+static_assert(std::is_trivially_copyable<Position>::value, "Position is copied on make");
+static_assert(sizeof(Position) <= 200, "Position is copied on make");
+
+#endif
@@ -0,0 +1,407 @@
+/*
+ * search.cc
+ * This file is part of chess, a console chess engine.
+ * Copyright (C) 2023 Cyprien Lacassagne
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include "search.h"
+#include "movegen.h"
+
+namespace {
+    constexpr int piece_values[nb_piece_types] = {100, 320, 330, 500, 900, 0};
+
+    /*
+     * Bonus of a piece on a square, for White. The tables read like a board
+     * seen from White: a8 first, h1 last.
+     */
+    constexpr int piece_squares[nb_piece_types][nb_squares] = {
+        {  0,  0,  0,  0,  0,  0,  0,  0,
+          50, 50, 50, 50, 50, 50, 50, 50,
+          10, 10, 20, 30, 30, 20, 10, 10,
+           5,  5, 10, 25, 25, 10,  5,  5,
+           0,  0,  0, 20, 20,  0,  0,  0,
+           5, -5,-10,  0,  0,-10, -5,  5,
+           5, 10, 10,-20,-20, 10, 10,  5,
+           0,  0,  0,  0,  0,  0,  0,  0},
+        {-50,-40,-30,-30,-30,-30,-40,-50,
+         -40,-20,  0,  0,  0,  0,-20,-40,
+         -30,  0, 10, 15, 15, 10,  0,-30,
+         -30,  5, 15, 20, 20, 15,  5,-30,
+         -30,  0, 15, 20, 20, 15,  0,-30,
+         -30,  5, 10, 15, 15, 10,  5,-30,
+         -40,-20,  0,  5,  5,  0,-20,-40,
+         -50,-40,-30,-30,-30,-30,-40,-50},
+        {-20,-10,-10,-10,-10,-10,-10,-20,
+         -10,  0,  0,  0,  0,  0,  0,-10,
+         -10,  0,  5, 10, 10,  5,  0,-10,
+         -10,  5,  5, 10, 10,  5,  5,-10,
+         -10,  0, 10, 10, 10, 10,  0,-10,
+         -10, 10, 10, 10, 10, 10, 10,-10,
+         -10,  5,  0,  0,  0,  0,  5,-10,
+         -20,-10,-10,-10,-10,-10,-10,-20},
+        {  0,  0,  0,  0,  0,  0,  0,  0,
+           5, 10, 10, 10, 10, 10, 10,  5,
+          -5,  0,  0,  0,  0,  0,  0, -5,
+          -5,  0,  0,  0,  0,  0,  0, -5,
+          -5,  0,  0,  0,  0,  0,  0, -5,
+          -5,  0,  0,  0,  0,  0,  0, -5,
+          -5,  0,  0,  0,  0,  0,  0, -5,
+           0,  0,  0,  5,  5,  0,  0,  0},
+        {-20,-10,-10, -5, -5,-10,-10,-20,
+         -10,  0,  0,  0,  0,  0,  0,-10,
+         -10,  0,  5,  5,  5,  5,  0,-10,
+          -5,  0,  5,  5,  5,  5,  0, -5,
+           0,  0,  5,  5,  5,  5,  0, -5,
+         -10,  5,  5,  5,  5,  5,  0,-10,
+         -10,  0,  5,  0,  0,  0,  0,-10,
+         -20,-10,-10, -5, -5,-10,-10,-20},
+        {-30,-40,-40,-50,-50,-40,-40,-30,
+         -30,-40,-40,-50,-50,-40,-40,-30,
+         -30,-40,-40,-50,-50,-40,-40,-30,
+         -30,-40,-40,-50,-50,-40,-40,-30,
+         -20,-30,-30,-40,-40,-30,-30,-20,
+         -10,-20,-20,-20,-20,-20,-20,-10,
+          20, 20,  0,  0,  0,  0, 20, 20,
+          20, 30, 10,  0,  0, 10, 30, 20}
+    };
+
+    // Mate scores are stored relative to the node, and read back relative to the root.
+    int score_to_tt(int score, int ply) {
+        return (score > mate_bound ? score + ply : score < -mate_bound ? score - ply : score);
+    }
+
+    int score_from_tt(int score, int ply) {
+        return (score > mate_bound ? score - ply : score < -mate_bound ? score + ply : score);
+    }
+
+    // Margin over the captured piece under which a capture can't raise alpha
+    constexpr int delta_margin(200);
+
+    int percent(uint64_t part, uint64_t total) { return (total ? int(100 * part / total) : 0); }
+
+    // Nodes searched between two looks at the clock
+    constexpr uint64_t clock_period(2048);
+    constexpr size_t pv_shown(8);
+}
+
+int eval::evaluate(const Position& pos) {
+    int score(0);
+    for (int pt(PAWN); pt <= KING; ++pt) {
+        // The table of White is flipped vertically for Black.
+        for (Bitboard b(pos.pieces(WHITE, PieceType(pt))); b; )
+            score += piece_values[pt] + piece_squares[pt][pop_lsb(b) ^ 56];
+        for (Bitboard b(pos.pieces(BLACK, PieceType(pt))); b; )
+            score -= piece_values[pt] + piece_squares[pt][pop_lsb(b)];
+    }
+    return (pos.side_to_move() == WHITE ? score : -score);
+}
+
+std::wstring to_string(const SearchResult& result) {
+    std::wstring str(L"depth " + std::to_wstring(result.depth) + L"  score ");
+    if (std::abs(result.score) > mate_bound) {
+        int plies(mate_score - std::abs(result.score));
+        str += L"mate " + std::wstring(result.score < 0 ? L"-" : L"")
+             + std::to_wstring((plies + 1) / 2);
+    }else
+        str += std::to_wstring(result.score) + L" cp";
+    str += L"  nodes " + std::to_wstring(result.nodes)
+         + L" (qs " + std::to_wstring(percent(result.qnodes, result.nodes)) + L"%)"
+         + L"  time " + std::to_wstring(int(result.seconds * 1000)) + L" ms"
+         + L"  tt hits " + std::to_wstring(percent(result.tt_hits, result.tt_probes))
+         + L"% cuts " + std::to_wstring(percent(result.tt_cutoffs, result.tt_probes)) + L"%"
+         + L"  first " + std::to_wstring(percent(result.first_move_cutoffs, result.cutoffs))
+         + L"%  pv";
+    for (size_t i(0); i < std::min(result.pv.size(), pv_shown); ++i)
+        str += L" " + to_coordinate(result.pv[i]);
+    return str;
+}
+
+Search::Search(const SearchLimits& _limits, TranspositionTable& _tt,
+               const std::vector<uint64_t>& _game_keys)
+:   limits(_limits), tt(_tt), game_keys(_game_keys), done(nullptr), nodes(0), qnodes(0), tt_probes(0), tt_hits(0), tt_cutoffs(0),
+    cutoffs(0), first_move_cutoffs(0), stopped(false) {}
+
+SearchResult Search::run(const Position& root) {
+    start = std::chrono::steady_clock::now();
+    tt.new_search();
+
+    // The helpers have no limit of their own: they run until the main search is done.
+    std::atomic<bool> main_done(false);
+    SearchLimits helper_limits{max_ply - 1, 0, 0, 1};
+    std::vector<std::unique_ptr<Search>> helpers;
+    std::vector<std::thread> threads;
+    for (int id(1); id < limits.threads; ++id) {
+        helpers.emplace_back(new Search(helper_limits, tt, game_keys));
+        Search* helper(helpers.back().get());
+        helper->done = &main_done;
+        helper->start = start;
+        threads.emplace_back([helper, &root, id]() { helper->iterate(root, 1 + id % 2); });
+    }
+
+    SearchResult result(iterate(root, 1));
+    main_done = true;
+    for (auto& thread : threads)
+        thread.join();
+    for (auto& helper : helpers) {
+        result.nodes += helper->nodes;
+        result.qnodes += helper->qnodes;
+        result.tt_probes += helper->tt_probes;
+        result.tt_hits += helper->tt_hits;
+        result.tt_cutoffs += helper->tt_cutoffs;
+        result.cutoffs += helper->cutoffs;
+        result.first_move_cutoffs += helper->first_move_cutoffs;
+    }
+    result.seconds = elapsed();
+    return result;
+}
+
+/**
+ * @param first_depth The depth of the first iteration.
+ * @return The result of the last iteration completed.
+ */
+SearchResult Search::iterate(const Position& root, int first_depth) {
+    nodes = qnodes = tt_probes = tt_hits = tt_cutoffs = 0;
+    cutoffs = first_move_cutoffs = 0;
+    stopped = false;
+    for (auto& k : killers)
+        k[0] = k[1] = PackedMove::none();
+    history.clear();
+    stack[0] = root;
+
+    MoveList moves;
+    movegen::generate_legal(root, moves);
+    SearchResult result{moves.empty() ? PackedMove::none() : moves[0], 0, 0, 0, 0, 0, {},
+                        0, 0, 0, 0, 0};
+    std::vector<PackedMove> order(moves.begin(), moves.end());
+
+    for (int depth(first_depth); depth <= std::min(limits.depth, max_ply - 1) && !moves.empty();
+         ++depth) {
+        pv_length[0] = 0;
+        // The best move of the last iteration is searched first.
+        std::stable_partition(order.begin(), order.end(),
+                              [&](PackedMove m) { return m == result.best; });
+        int alpha(-infinite_score);
+        PackedMove best(PackedMove::none());
+        for (auto move : order) {
+            stack[1] = stack[0];
+            stack[1].do_move(move);
+            int score(-search(1, depth-1, -infinite_score, -alpha));
+            // A move cut short by the stop has no score.
+            if (stopped)
+                break;
+            if (score > alpha) {
+                alpha = score;
+                best = move;
+                updt_pv(0, move);
+            }
+        }
+        // An iteration cut short is dropped, unless it is the first one: then
+        // the best of the moves it searched is still better than none.
+        if (stopped && (depth > first_depth || best == PackedMove::none()))
+            break;
+
+        result.best = best;
+        result.score = alpha;
+        result.depth = depth;
+        result.pv.assign(pv[0], pv[0] + pv_length[0]);
+        // No deeper search can find a shorter mate. Past half the time, the
+        // next iteration would most likely be dropped.
+        if (std::abs(alpha) > mate_bound || out_of_budget()
+            || (limits.movetime && elapsed() * 2000 >= limits.movetime))
+            break;
+    }
+    result.nodes = nodes;
+    result.qnodes = qnodes;
+    result.tt_probes = tt_probes;
+    result.tt_hits = tt_hits;
+    result.tt_cutoffs = tt_cutoffs;
+    result.cutoffs = cutoffs;
+    result.first_move_cutoffs = first_move_cutoffs;
+    return result;
+}
+
+int Search::search(int ply, int depth, int alpha, int beta) {
+    if (stack[ply].side_to_move() == WHITE)
+        return search<WHITE>(ply, depth, alpha, beta);
+    return search<BLACK>(ply, depth, alpha, beta);
+}
+
+// Negamax Framework
+template<Color Us>
+int Search::search(int ply, int depth, int alpha, int beta) {
+    if (depth == 0)
+        return quiesce<Us>(ply, alpha, beta);
+    if (++nodes % clock_period == 0 && out_of_budget())
+        stopped = true;
+    if (stopped)
+        return 0;
+
+    pv_length[ply] = ply;
+    const Position& pos(stack[ply]);
+    if (ply >= max_ply - 1)
+        return eval::evaluate(pos);
+    if (is_repetition(ply))
+        return 0;
+
+    // A result at least as deep as the one needed may end the search here.
+    TTEntry entry;
+    PackedMove tt_move(PackedMove::none());
+    ++tt_probes;
+    if (tt.probe(pos.key(), entry)) {
+        ++tt_hits;
+        tt_move = entry.move;
+        int score(score_from_tt(entry.score, ply));
+        if (entry.depth >= depth
+            && (entry.bound == BOUND_EXACT
+                || (entry.bound == BOUND_LOWER && score >= beta)
+                || (entry.bound == BOUND_UPPER && score <= alpha))) {
+            ++tt_cutoffs;
+            return std::max(alpha, std::min(score, beta));
+        }
+    }
+
+    MovePicker picker(pos, tt_move, killers[ply], history);
+    int alpha_orig(alpha);
+    PackedMove best(PackedMove::none());
+    int n_moves(0);
+    for (PackedMove move(picker.next()); !move.is_none(); move = picker.next()) {
+        ++n_moves;
+        stack[ply+1] = pos;
+        stack[ply+1].do_move<Us>(move);
+        int score(-search<!Us>(ply + 1, depth-1, -beta, -alpha));
+        if (stopped)
+            return 0;
+        if (score >= beta) {
+            ++cutoffs;
+            first_move_cutoffs += (n_moves == 1);
+            if (pos.is_empty(move.to()) && move.type() != PackedMove::EN_PASSANT
+                && move.type() != PackedMove::PROMOTION)
+                updt_quiet_stats(ply, depth, move);
+            tt.store(pos.key(), move, score_to_tt(beta, ply), depth, BOUND_LOWER);
+            return beta;
+        }
+        if (score > alpha) {
+            alpha = score;
+            best = move;
+            updt_pv(ply, move);
+        }
+    }
+    if (!n_moves) {
+        // Mates closer to the root score higher.
+        if (movegen::checkers(pos))
+            return -mate_score + ply;
+        return 0;
+    }
+    tt.store(pos.key(), best, score_to_tt(alpha, ply), depth,
+             alpha > alpha_orig ? BOUND_EXACT : BOUND_UPPER);
+    return alpha;
+}
+
+/*
+ * Only the captures and promotions are searched, the side to move standing
+ * pat on the evaluation if it has nothing better. In check, every evasion is.
+ */
+template<Color Us>
+int Search::quiesce(int ply, int alpha, int beta) {
+    ++qnodes;
+    if (++nodes % clock_period == 0 && out_of_budget())
+        stopped = true;
+    if (stopped)
+        return 0;
+
+    pv_length[ply] = ply;
+    const Position& pos(stack[ply]);
+    if (ply >= max_ply - 1)
+        return eval::evaluate(pos);
+
+    bool in_check(movegen::checkers(pos));
+    int stand_pat(-infinite_score);
+    if (!in_check) {
+        stand_pat = eval::evaluate(pos);
+        if (stand_pat >= beta)
+            return beta;
+        alpha = std::max(alpha, stand_pat);
+    }
+    MovePicker picker(pos, in_check, history);
+    int n_moves(0);
+    for (PackedMove move(picker.next()); !move.is_none(); move = picker.next()) {
+        ++n_moves;
+        // Delta pruning: even winning the piece for free would not raise alpha.
+        if (!in_check && move.type() != PackedMove::PROMOTION) {
+            PieceType captured(move.type() == PackedMove::EN_PASSANT ? PAWN
+                                                                     : pos.type_on(move.to()));
+            if (stand_pat + piece_values[captured] + delta_margin <= alpha)
+                continue;
+        }
+        stack[ply+1] = pos;
+        stack[ply+1].do_move<Us>(move);
+        int score(-quiesce<!Us>(ply + 1, -beta, -alpha));
+        if (stopped)
+            return 0;
+        if (score >= beta)
+            return beta;
+        if (score > alpha) {
+            alpha = score;
+            updt_pv(ply, move);
+        }
+    }
+    if (in_check && !n_moves)
+        return -mate_score + ply;
+    return alpha;
+}
+
+bool Search::is_repetition(int ply) const {
+    // The key holds the side to move: only every other ply can match.
+    uint64_t key(stack[ply].key());
+    for (int i(ply - 2); i >= 0; i -= 2) {
+        if (stack[i].key() == key)
+            return true;
+    }
+    // The root is the last position of the game, already on the path.
+    for (size_t i(0); i + 1 < game_keys.size(); ++i) {
+        if (game_keys[i] == key)
+            return true;
+    }
+    return false;
+}
+
+void Search::updt_pv(int ply, PackedMove move) {
+    pv[ply][ply] = move;
+    for (int i(ply + 1); i < pv_length[ply+1]; ++i)
+        pv[ply][i] = pv[ply+1][i];
+    pv_length[ply] = std::max(pv_length[ply+1], ply + 1);
+}
+
+void Search::updt_quiet_stats(int ply, int depth, PackedMove move) {
+    if (killers[ply][0] != move) {
+        killers[ply][1] = killers[ply][0];
+        killers[ply][0] = move;
+    }
+    history.update(stack[ply].side_to_move(), move, depth);
+}
+
+bool Search::out_of_budget() const {
+    return (done && done->load(std::memory_order_relaxed))
+        || (limits.nodes && nodes >= limits.nodes)
+        || (limits.movetime && elapsed() * 1000 >= limits.movetime);
+}
+
+double Search::elapsed() const {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
@@ -0,0 +1,145 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#include <cstdint>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <atomic>
+#include "common.h"
+#include "position.h"
+#include "move.h"
+#include "tt.h"
+#include "movepick.h"
+
+/* Scores are in centipawns, from the side to move's point of view. */
+constexpr int mate_score(32000);
+constexpr int infinite_score(mate_score + 1);
+// Scores beyond this one announce a mate
+constexpr int mate_bound(mate_score - max_ply);
+
+struct SearchLimits {
+    int depth = max_ply - 1;
+    // No limit if 0
+    uint64_t nodes = 0;
+    int movetime = 1000;
+    int threads = 1;
+};
+
+/* Depth of the searches timed by --bench */
+constexpr int default_bench_depth(9);
+
+struct SearchResult {
+    PackedMove best;
+    int score;
+    // Depth of the last iteration completed
+    int depth;
+    // Nodes of every thread
+    uint64_t nodes;
+    // Nodes of the quiescence search, counted in the nodes above
+    uint64_t qnodes;
+    double seconds;
+    std::vector<PackedMove> pv;
+    // Lookups in the transposition table, those that found the position and
+    // those whose score ended the search of the node
+    uint64_t tt_probes;
+    uint64_t tt_hits;
+    uint64_t tt_cutoffs;
+    // Nodes that failed high, and those that did on their first move
+    uint64_t cutoffs;
+    uint64_t first_move_cutoffs;
+};
+
+/**
+ * @return The result on one line: depth, score, nodes and the share of the
+ *         quiescence search, time, transposition table hits and cutoffs, share
+ *         of the cutoffs on the first move and the first moves of the principal
+ *         variation.
+ */
+std::wstring to_string(const SearchResult& result);
+
+/*
+ * Alpha-beta search in a negamax framework, driven by iterative deepening:
+ * the root is searched one ply deeper at each iteration, best move first,
+ * until a limit is reached. An iteration stopped by a limit is dropped, so
+ * the result always comes from a complete one.
+ *
+ * At the horizon, a quiescence search plays the captures and promotions
+ * out until the position is quiet, so that no position is evaluated in the
+ * middle of an exchange.
+ *
+ * The moves are searched best first, as told by a MovePicker, so that the
+ * cutoffs come early. The killers and the history it reads are learnt from
+ * the cutoffs of the search itself.
+ *
+ * A position met before, in the game or on the path from the root, is
+ * scored as a draw: the side that is better off then avoids repeating.
+ *
+ * Like perft, the search walks a stack of positions, one per ply. The
+ * results of the nodes go to a transposition table, which outlives the
+ * search: the next iterations and the next moves reuse them.
+ *
+ * With several threads (Lazy SMP), helper searches run on the same root
+ * and share only the table, half of them one ply ahead so that they do
+ * not follow the main one step for step. They fill the table with results
+ * the main search finds there, and stop with it: the move played is the
+ * one of the main search. The limits of nodes and time apply to the main
+ * search only.
+ */
+class Search {
+public:
+    /**
+     * @param game_keys The keys of the positions of the game, the root last,
+     *                  so that the search sees the repetitions.
+     */
+    Search(const SearchLimits& limits, TranspositionTable& tt,
+           const std::vector<uint64_t>& game_keys);
+
+    /**
+     * @param root A position with at least one legal move.
+     * @return The best move found, with its score and principal variation.
+     */
+    SearchResult run(const Position& root);
+
+private:
+    Position stack[max_ply + 1];
+    // Principal variations found below each ply, triangular
+    PackedMove pv[max_ply][max_ply];
+    int pv_length[max_ply];
+    // The last two quiet moves that caused a cutoff at each ply
+    PackedMove killers[max_ply][2];
+    HistoryTable history;
+
+    SearchLimits limits;
+    TranspositionTable& tt;
+    const std::vector<uint64_t>& game_keys;
+    // Set by the main search once it is done, for its helpers
+    const std::atomic<bool>* done;
+    uint64_t nodes, qnodes;
+    uint64_t tt_probes, tt_hits, tt_cutoffs;
+    uint64_t cutoffs, first_move_cutoffs;
+    std::chrono::steady_clock::time_point start;
+    bool stopped;
+
+    SearchResult iterate(const Position& root, int first_depth);
+    int search(int ply, int depth, int alpha, int beta);
+    template<Color Us>
+    int search(int ply, int depth, int alpha, int beta);
+    template<Color Us>
+    int quiesce(int ply, int alpha, int beta);
+    bool is_repetition(int ply) const;
+    void updt_pv(int ply, PackedMove move);
+    void updt_quiet_stats(int ply, int depth, PackedMove move);
+    bool out_of_budget() const;
+    double elapsed() const;
+};
+
+namespace eval {
+    /**
+     * Material and placement of the pieces.
+     * @return The score of the position for the side to move.
+     */
+    int evaluate(const Position& pos);
+}
+
+#endif
@@ -0,0 +1,99 @@
+/*
+ * tt.cc
+ * This file is part of chess, a console chess engine.
+ * Copyright (C) 2023 Cyprien Lacassagne
+
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include "tt.h"
+
+namespace {
+    uint64_t pack(PackedMove move, int score, int depth, Bound bound, int generation) {
+        return uint64_t(move.raw()) | uint64_t(uint16_t(int16_t(score))) << 16
+             | uint64_t(uint8_t(depth)) << 32 | uint64_t(bound) << 40
+             | uint64_t(generation) << 42;
+    }
+
+    TTEntry unpack(uint64_t data) {
+        return {PackedMove::from_raw(uint16_t(data)), int16_t(data >> 16),
+                int(data >> 32 & 0xFF), Bound(data >> 40 & 0x3)};
+    }
+
+    int depth_of(uint64_t data) { return int(data >> 32 & 0xFF); }
+}
+
+TranspositionTable::TranspositionTable(int mb)
+:   mask(0), generation(0) {
+    resize(mb);
+}
+
+void TranspositionTable::resize(int mb) {
+    size_t n_buckets(1);
+    while (n_buckets * 2 * sizeof(Bucket) <= (size_t(mb) << 20))
+        n_buckets *= 2;
+    buckets = std::vector<Bucket>(n_buckets);
+    mask = n_buckets - 1;
+    clear();
+}
+
+void TranspositionTable::clear() {
+    for (auto& bucket : buckets) {
+        for (auto& slot : bucket.slots) {
+            slot.check.store(0, std::memory_order_relaxed);
+            slot.data.store(0, std::memory_order_relaxed);
+        }
+    }
+    generation = 0;
+}
+
+bool TranspositionTable::probe(uint64_t key, TTEntry& entry) const {
+    const Bucket& bucket(buckets[key & mask]);
+    for (const auto& slot : bucket.slots) {
+        uint64_t data(slot.data.load(std::memory_order_relaxed));
+        if ((slot.check.load(std::memory_order_relaxed) ^ data) == key
+            && Bound(data >> 40 & 0x3) != BOUND_NONE) {
+            entry = unpack(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranspositionTable::store(uint64_t key, PackedMove move, int score, int depth,
+                               Bound bound) {
+    Bucket& bucket(buckets[key & mask]);
+    Slot* victim(&bucket.slots[0]);
+    uint64_t victim_data(victim->data.load(std::memory_order_relaxed));
+    for (auto& slot : bucket.slots) {
+        uint64_t data(slot.data.load(std::memory_order_relaxed));
+        if ((slot.check.load(std::memory_order_relaxed) ^ data) == key) {
+            // A deeper result of the same search is kept, with its move.
+            if (bound != BOUND_EXACT && depth < depth_of(data) && !age(data))
+                return;
+            if (move.is_none())
+                move = unpack(data).move;
+            victim = &slot;
+            break;
+        }
+        // Each generation past weighs as much as eight plies.
+        if (depth_of(data) - 8 * age(data) < depth_of(victim_data) - 8 * age(victim_data)) {
+            victim = &slot;
+            victim_data = data;
+        }
+    }
+    uint64_t data(pack(move, score, depth, bound, generation));
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+    victim->data.store(data, std::memory_order_relaxed);
+}
@@ -0,0 +1,92 @@
+#ifndef TT_H
+#define TT_H
+
+#include <cstdint>
+#include <vector>
+#include <atomic>
+#include "move.h"
+
+/* Default size of the transposition table, in megabytes */
+constexpr int default_hash_mb(16);
+
+/* What the score of an entry tells about the true score */
+enum Bound {
+    BOUND_NONE,
+    BOUND_UPPER,    // The search failed low: the true score is at most this one
+    BOUND_LOWER,    // The search failed high: the true score is at least this one
+    BOUND_EXACT
+};
+
+struct TTEntry {
+    PackedMove move;
+    int score;
+    int depth;
+    Bound bound;
+};
+
+/*
+ * Results of the search, indexed by Zobrist key. The entries are grouped by
+ * four in buckets of a cache line, so that a probe reads one line of memory.
+ * A key picks a bucket, and it may then stand in any of its entries.
+ *
+ * Each search starts a new generation. When a bucket is full, the entry
+ * replaced is the shallowest one, entries of past searches counting as
+ * shallower than they are.
+ *
+ * The threads of a search share the table without locks. Like the perft
+ * table, a slot stores its key xored with its data: a slot torn by two
+ * threads writing at once no longer matches its key, and is missed.
+ */
+class TranspositionTable {
+public:
+    /* @param mb The size in megabytes, rounded down to a power of two buckets. */
+    explicit TranspositionTable(int mb);
+
+    void resize(int mb);
+    void clear();
+    void new_search() { generation = (generation + 1) % nb_generations; }
+
+    /**
+     * @param key The Zobrist key of the position.
+     * @param entry Receives the entry of the position, if found.
+     * @return <tt>true</tt> if the position was found.
+     */
+    bool probe(uint64_t key, TTEntry& entry) const;
+
+    /**
+     * @param score The score, mates counted from the position itself.
+     * @param depth The depth searched below the position.
+     */
+    void store(uint64_t key, PackedMove move, int score, int depth, Bound bound);
+
+    size_t size_mb() const { return buckets.size() * sizeof(Bucket) >> 20; }
+
+private:
+    static constexpr int bucket_size = 4;
+    static constexpr int nb_generations = 64;
+
+    /*
+     * The data packs the move (bits 0-15), the score (16-31), the depth
+     * (32-39), the bound (40-41) and the generation (42-47).
+     */
+    struct Slot {
+        std::atomic<uint64_t> check;
+        std::atomic<uint64_t> data;
+    };
+
+    struct alignas(64) Bucket {
+        Slot slots[bucket_size];
+    };
+
+    static_assert(sizeof(Bucket) == 64, "A bucket fills a cache line");
+
+    std::vector<Bucket> buckets;
+    uint64_t mask;
+    int generation;
+
+    int age(uint64_t data) const {
+        return (generation - int(data >> 42 & 0x3F) + nb_generations) % nb_generations;
+    }
+};
+
+#endif
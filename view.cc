@@ -95,13 +95,6 @@ namespace {
     const std::wstring magenta(L"\x1b[48;5;5m");
     const std::wstring green(L"\x1b[48;5;28m");
 
-    struct ColorScheme {
-        std::wstring light_sqr;
-        std::wstring dark_sqr;
-        ColorScheme(std::wstring lt, std::wstring dk)
-        :   light_sqr(lt), dark_sqr(dk) {}
-    };
-
     /* Color schemes */
     const ColorScheme standard(beige, brown);
     const ColorScheme gnu_chess(light_grey, magenta);
@@ -116,21 +109,12 @@ namespace {
     };
 
     void color_scheme_menu();
-    void set_color_scheme(size_t id);
-    std::wstring get_graphic_string(bool w_turn, char code, int col, int rank,
-                                    Square start_sqr, Square target_sqr, bool check);
-    std::wstring get_graphic_string(bool w_pov, char code, int col, int rank);
-    void code_to_sgr(std::wstring& sgr_string, char code);
-
-    bool alt_piece_style(false);
-    bool pseudo_ascii(false);
-    bool ascii(false);
-    std::wstring output_string;
-    ColorScheme scheme(beige, brown);
 } /* unnamed namespace */
 
+View::View()
+:   alt_piece_style(false), pseudo_ascii(false), ascii(false), scheme(standard) {}
 
-bool customize_style() {
+bool View::customize_style() {
     color_scheme_menu();
     size_t select;
     if (!(std::wcin >> select)) {
@@ -170,8 +154,8 @@ bool customize_style() {
     return true;
 }
 
-void view::print_board(Chessboard b, bool white_pov, Square start_sqr, Square target_sqr,
-                    bool check, bool cvc) {
+void View::print_board(Chessboard b, bool white_pov, Square start_sqr, Square target_sqr,
+                       bool check, bool cvc) {
     output_string.clear();
     if (white_pov || cvc) {
         for (int i(board_size-1); i >= 0; --i) {
@@ -210,7 +194,7 @@ void view::print_board(Chessboard b, bool white_pov, Square start_sqr, Square ta
     std::wcout << output_string;
 }
 
-void view::print_board(Chessboard chessboard, bool w_pov) {
+void View::print_board(Chessboard chessboard, bool w_pov) {
     output_string.clear();
     if (w_pov) {
         for (int i(board_size-1); i >= 0; --i) {
@@ -250,244 +234,245 @@ namespace {
         std::wcout << "[" << c_schemes.size() << "]\t" << pAscii_demo << "\n"
                    << "[" << c_schemes.size() + 1 << "]\t" << ascii_demo << "\n";
     }
+}
 
-    void set_color_scheme(size_t id) {
-        if (id < 0 || id >= c_schemes.size() + 2)
-            return;
-        if (id == c_schemes.size()) {
-            pseudo_ascii = true;
-            ascii = false;
-            return;
-        }
-        if (id == c_schemes.size() + 1) {
-            ascii = true;
-            pseudo_ascii = false;
-            return;
-        }
-        scheme = c_schemes[id];
-        pseudo_ascii = false;
+void View::set_color_scheme(size_t id) {
+    if (id < 0 || id >= c_schemes.size() + 2)
+        return;
+    if (id == c_schemes.size()) {
+        pseudo_ascii = true;
         ascii = false;
+        return;
+    }
+    if (id == c_schemes.size() + 1) {
+        ascii = true;
+        pseudo_ascii = false;
+        return;
     }
+    scheme = c_schemes[id];
+    pseudo_ascii = false;
+    ascii = false;
+}
 
-    std::wstring get_graphic_string(bool w_turn, char code, int file, int rank,
-                                    Square start_sqr, Square target_sqr, bool check) {
-        std::wstring sgr_square;
-        // Chessboard alternating pattern.
-        if (rank % 2) {
-            if (file % 2) {
-                if (pseudo_ascii)
-                    sgr_square = pAscii_light_sqr;
-                else if (!ascii)
-                    sgr_square = scheme.light_sqr;
-            }
-            else {
-                if (pseudo_ascii)
-                    sgr_square = pAscii_dark_sqr;
-                else if (!ascii)
-                    sgr_square = scheme.dark_sqr;
-            }
-        }else {
-            if (file % 2) {
-                if (pseudo_ascii)
-                    sgr_square = pAscii_dark_sqr;
-                else if (!ascii)
-                    sgr_square = scheme.dark_sqr;
-            }
-            else {
-                if (pseudo_ascii)
-                    sgr_square = pAscii_light_sqr;
-                else if (!ascii)
-                    sgr_square = scheme.light_sqr;
-            }
+std::wstring View::get_graphic_string(bool w_turn, char code, int file, int rank,
+                                      Square start_sqr, Square target_sqr,
+                                      bool check) const {
+    std::wstring sgr_square;
+    // Chessboard alternating pattern.
+    if (rank % 2) {
+        if (file % 2) {
+            if (pseudo_ascii)
+                sgr_square = pAscii_light_sqr;
+            else if (!ascii)
+                sgr_square = scheme.light_sqr;
+        }
+        else {
+            if (pseudo_ascii)
+                sgr_square = pAscii_dark_sqr;
+            else if (!ascii)
+                sgr_square = scheme.dark_sqr;
         }
+    }else {
+        if (file % 2) {
+            if (pseudo_ascii)
+                sgr_square = pAscii_dark_sqr;
+            else if (!ascii)
+                sgr_square = scheme.dark_sqr;
+        }
+        else {
+            if (pseudo_ascii)
+                sgr_square = pAscii_light_sqr;
+            else if (!ascii)
+                sgr_square = scheme.light_sqr;
+        }
+    }
 
-        // Green background for the start and target squares.
-        if (!pseudo_ascii && !ascii) {
-            char strt_file(start_sqr.file);
-            int strt_rank(start_sqr.rank);
-            if (strt_file != blank && strt_rank >= 1 && strt_rank <= board_size) {
-                if (rank == strt_rank-1 && file == int('h')-int(strt_file)) {
-                    if (rank % 2) {
-                        if (file % 2) sgr_square = light_target_sqr;
-                        else sgr_square = dark_target_sqr;
-                    }else {
-                        if (file % 2) sgr_square = dark_target_sqr;
-                        else sgr_square = light_target_sqr;
-                    }
+    // Green background for the start and target squares.
+    if (!pseudo_ascii && !ascii) {
+        char strt_file(start_sqr.file);
+        int strt_rank(start_sqr.rank);
+        if (strt_file != blank && strt_rank >= 1 && strt_rank <= board_size) {
+            if (rank == strt_rank-1 && file == int('h')-int(strt_file)) {
+                if (rank % 2) {
+                    if (file % 2) sgr_square = light_target_sqr;
+                    else sgr_square = dark_target_sqr;
+                }else {
+                    if (file % 2) sgr_square = dark_target_sqr;
+                    else sgr_square = light_target_sqr;
                 }
             }
-            char trgt_file(target_sqr.file);
-            int trgt_rank(target_sqr.rank);
-            if (trgt_file != blank && trgt_rank >= 1 && trgt_rank <= board_size) {
-                if (rank == trgt_rank-1 && file == int('h')-int(trgt_file)) {
-                    if (rank % 2) {
-                        if (file % 2) sgr_square = light_target_sqr;
-                        else sgr_square = dark_target_sqr;
-                    }else {
-                        if (file % 2) sgr_square = dark_target_sqr;
-                        else sgr_square = light_target_sqr;
-                    }
+        }
+        char trgt_file(target_sqr.file);
+        int trgt_rank(target_sqr.rank);
+        if (trgt_file != blank && trgt_rank >= 1 && trgt_rank <= board_size) {
+            if (rank == trgt_rank-1 && file == int('h')-int(trgt_file)) {
+                if (rank % 2) {
+                    if (file % 2) sgr_square = light_target_sqr;
+                    else sgr_square = dark_target_sqr;
+                }else {
+                    if (file % 2) sgr_square = dark_target_sqr;
+                    else sgr_square = light_target_sqr;
                 }
             }
         }
+    }
 
-        // Red background in case of a check.
-        if (check) {
-            if (w_turn) {
-                if (code == 'K') sgr_square = check_sqr;
-            }else if (code == 'k') sgr_square = check_sqr;
-        }
-
-        // Add the correct foreground sgr depending on the piece to print.
-        code_to_sgr(sgr_square, code);
-        
-        return sgr_square;
+    // Red background in case of a check.
+    if (check) {
+        if (w_turn) {
+            if (code == 'K') sgr_square = check_sqr;
+        }else if (code == 'k') sgr_square = check_sqr;
     }
 
-    std::wstring get_graphic_string(bool w_pov, char code, int file, int rank) {
-        std::wstring sgr_square;
-        // Chessboard alternating pattern.
-        if (rank % 2) {
-            if (file % 2) {
-                if (pseudo_ascii)
-                    sgr_square = pAscii_light_sqr;
-                else if (!ascii)
-                    sgr_square = scheme.light_sqr;
-            }
-            else {
-                if (pseudo_ascii)
-                    sgr_square = pAscii_dark_sqr;
-                else if (!ascii)
-                    sgr_square = scheme.dark_sqr;
-            }
-        }else {
-            if (file % 2) {
-                if (pseudo_ascii)
-                    sgr_square = pAscii_dark_sqr;
-                else if (!ascii)
-                    sgr_square = scheme.dark_sqr;
-            }
-            else {
-                if (pseudo_ascii)
-                    sgr_square = pAscii_light_sqr;
-                else if (!ascii)
-                    sgr_square = scheme.light_sqr;
-            }
+    // Add the correct foreground sgr depending on the piece to print.
+    code_to_sgr(sgr_square, code);
+    
+    return sgr_square;
+}
+
+std::wstring View::get_graphic_string(bool w_pov, char code, int file, int rank) const {
+    std::wstring sgr_square;
+    // Chessboard alternating pattern.
+    if (rank % 2) {
+        if (file % 2) {
+            if (pseudo_ascii)
+                sgr_square = pAscii_light_sqr;
+            else if (!ascii)
+                sgr_square = scheme.light_sqr;
+        }
+        else {
+            if (pseudo_ascii)
+                sgr_square = pAscii_dark_sqr;
+            else if (!ascii)
+                sgr_square = scheme.dark_sqr;
+        }
+    }else {
+        if (file % 2) {
+            if (pseudo_ascii)
+                sgr_square = pAscii_dark_sqr;
+            else if (!ascii)
+                sgr_square = scheme.dark_sqr;
+        }
+        else {
+            if (pseudo_ascii)
+                sgr_square = pAscii_light_sqr;
+            else if (!ascii)
+                sgr_square = scheme.light_sqr;
         }
-        code_to_sgr(sgr_square, code);
-        return sgr_square;
     }
+    code_to_sgr(sgr_square, code);
+    return sgr_square;
+}
 
-    void code_to_sgr(std::wstring& sgr_string, char code) {
-        switch (code) {
-            case '.':
-            // case '!':
-                if (!pseudo_ascii && !ascii)
-                    sgr_string += empty_square;
-                if (!pseudo_ascii && ascii)
-                    sgr_string += ascii_square;
-                break;
-            case 'K':
-                if (pseudo_ascii)
-                    sgr_string = pAscii_w_king;
-                else if (ascii)
-                    sgr_string = ascii_w_king;
-                else
-                    sgr_string += (alt_piece_style ? w_king_bis : w_king);
-                break;
-            case 'Q':
-                if (pseudo_ascii)
-                    sgr_string = pAscii_w_queen;
-                else if (ascii)
-                    sgr_string = ascii_w_queen;
-                else
-                    sgr_string += (alt_piece_style ? w_queen_bis : w_queen);
-                break;
-            case 'R':
-                if (pseudo_ascii)
-                    sgr_string = pAscii_w_rook;
-                else if (ascii)
-                    sgr_string = ascii_w_rook;
-                else
-                    sgr_string += (alt_piece_style ? w_rook_bis : w_rook);
-                break;
-            case 'B':
-                if (pseudo_ascii)
-                    sgr_string = pAscii_w_bishop;
-                else if (ascii)
-                    sgr_string = ascii_w_bishop;
-                else
-                    sgr_string += (alt_piece_style ? w_bishop_bis : w_bishop);
-                break;
-            case 'N':
-                if (pseudo_ascii)
-                    sgr_string = pAscii_w_knight;
-                else if (ascii)
-                    sgr_string = ascii_w_knight;
-                else
-                    sgr_string += (alt_piece_style ? w_knight_bis : w_knight);
-                break;
-            case 'P':
-                if (pseudo_ascii)
-                    sgr_string = pAscii_w_pawn;
-                else if (ascii)
-                    sgr_string = ascii_w_pawn;
-                else
-                    sgr_string += (alt_piece_style ? w_pawn_bis : w_pawn);
-                break;
-            case 'k':
-                if (pseudo_ascii)
-                    sgr_string = pAscii_b_king;
-                else if (ascii)
-                    sgr_string = ascii_b_king;
-                else
-                    sgr_string += b_king;
-                break;
-            case 'q':
-                if (pseudo_ascii)
-                    sgr_string = pAscii_b_queen;
-                else if (ascii)
-                    sgr_string = ascii_b_queen;
-                else
-                    sgr_string += b_queen;
-                break;
-            case 'r':
-                if (pseudo_ascii)
-                    sgr_string = pAscii_b_rook;
-                else if (ascii)
-                    sgr_string = ascii_b_rook;
-                else
-                    sgr_string += b_rook;
-                break;
-            case 'b':
-                if (pseudo_ascii)
-                    sgr_string = pAscii_b_bishop;
-                else if (ascii)
-                    sgr_string = ascii_b_bishop;
-                else
-                    sgr_string += b_bishop;
-                break;
-            case 'n':
-                if (pseudo_ascii)
-                    sgr_string = pAscii_b_knight;
-                else if (ascii)
-                    sgr_string = ascii_b_knight;
-                else
-                    sgr_string += b_knight;
-                break;
-            case 'p':
-                if (pseudo_ascii)
-                    sgr_string = pAscii_b_pawn;
-                else if (ascii)
-                    sgr_string = ascii_b_pawn;
-                else
-                    sgr_string += b_pawn;
-                break;
-            case '!':
-                sgr_string += magenta + L"  " + reset_sgr;
-                break;
-            default:
-                sgr_string += L"\x1b[31m? ";
-        }
+void View::code_to_sgr(std::wstring& sgr_string, char code) const {
+    switch (code) {
+        case '.':
+        // case '!':
+            if (!pseudo_ascii && !ascii)
+                sgr_string += empty_square;
+            if (!pseudo_ascii && ascii)
+                sgr_string += ascii_square;
+            break;
+        case 'K':
+            if (pseudo_ascii)
+                sgr_string = pAscii_w_king;
+            else if (ascii)
+                sgr_string = ascii_w_king;
+            else
+                sgr_string += (alt_piece_style ? w_king_bis : w_king);
+            break;
+        case 'Q':
+            if (pseudo_ascii)
+                sgr_string = pAscii_w_queen;
+            else if (ascii)
+                sgr_string = ascii_w_queen;
+            else
+                sgr_string += (alt_piece_style ? w_queen_bis : w_queen);
+            break;
+        case 'R':
+            if (pseudo_ascii)
+                sgr_string = pAscii_w_rook;
+            else if (ascii)
+                sgr_string = ascii_w_rook;
+            else
+                sgr_string += (alt_piece_style ? w_rook_bis : w_rook);
+            break;
+        case 'B':
+            if (pseudo_ascii)
+                sgr_string = pAscii_w_bishop;
+            else if (ascii)
+                sgr_string = ascii_w_bishop;
+            else
+                sgr_string += (alt_piece_style ? w_bishop_bis : w_bishop);
+            break;
+        case 'N':
+            if (pseudo_ascii)
+                sgr_string = pAscii_w_knight;
+            else if (ascii)
+                sgr_string = ascii_w_knight;
+            else
+                sgr_string += (alt_piece_style ? w_knight_bis : w_knight);
+            break;
+        case 'P':
+            if (pseudo_ascii)
+                sgr_string = pAscii_w_pawn;
+            else if (ascii)
+                sgr_string = ascii_w_pawn;
+            else
+                sgr_string += (alt_piece_style ? w_pawn_bis : w_pawn);
+            break;
+        case 'k':
+            if (pseudo_ascii)
+                sgr_string = pAscii_b_king;
+            else if (ascii)
+                sgr_string = ascii_b_king;
+            else
+                sgr_string += b_king;
+            break;
+        case 'q':
+            if (pseudo_ascii)
+                sgr_string = pAscii_b_queen;
+            else if (ascii)
+                sgr_string = ascii_b_queen;
+            else
+                sgr_string += b_queen;
+            break;
+        case 'r':
+            if (pseudo_ascii)
+                sgr_string = pAscii_b_rook;
+            else if (ascii)
+                sgr_string = ascii_b_rook;
+            else
+                sgr_string += b_rook;
+            break;
+        case 'b':
+            if (pseudo_ascii)
+                sgr_string = pAscii_b_bishop;
+            else if (ascii)
+                sgr_string = ascii_b_bishop;
+            else
+                sgr_string += b_bishop;
+            break;
+        case 'n':
+            if (pseudo_ascii)
+                sgr_string = pAscii_b_knight;
+            else if (ascii)
+                sgr_string = ascii_b_knight;
+            else
+                sgr_string += b_knight;
+            break;
+        case 'p':
+            if (pseudo_ascii)
+                sgr_string = pAscii_b_pawn;
+            else if (ascii)
+                sgr_string = ascii_b_pawn;
+            else
+                sgr_string += b_pawn;
+            break;
+        case '!':
+            sgr_string += magenta + L"  " + reset_sgr;
+            break;
+        default:
+            sgr_string += L"\x1b[31m? ";
     }
 }
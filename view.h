@@ -7,11 +7,45 @@
 #include <vector>
 #include "common.h"
 
-namespace view {
+struct ColorScheme {
+    std::wstring light_sqr;
+    std::wstring dark_sqr;
+    ColorScheme(std::wstring lt, std::wstring dk)
+    :   light_sqr(lt), dark_sqr(dk) {}
+};
+
+/*
+ * Draws the board in the terminal. The style chosen by the user and the
+ * output buffer belong to the view, each game having its own.
+ */
+class View {
+public:
+    View();
+
     void print_board(Chessboard, bool w_pov, Square start_sqr, Square target_sqr,
                      bool check, bool cvc);
     void print_board(Chessboard, bool w_pov);
-}
+
+    /**
+     * Ask the user for a color scheme and a style of pieces.
+     * @return <tt>false</tt> if the answer is not a number.
+     */
+    bool customize_style();
+
+private:
+    void set_color_scheme(size_t id);
+    std::wstring get_graphic_string(bool w_turn, char code, int col, int rank,
+                                    Square start_sqr, Square target_sqr,
+                                    bool check) const;
+    std::wstring get_graphic_string(bool w_pov, char code, int col, int rank) const;
+    void code_to_sgr(std::wstring& sgr_string, char code) const;
+
+    bool alt_piece_style;
+    bool pseudo_ascii;
+    bool ascii;
+    std::wstring output_string;
+    ColorScheme scheme;
+};
 
 /* CSI SEQUENCES */
 // SGR for text
@@ -29,7 +63,4 @@ const std::wstring cursor_up(L"\x1b[A");
 const std::wstring save_cursor_pos(L"\x1b[s");
 const std::wstring restore_cursor_pos(L"\x1b[u");
 
-/* Functions */
-bool customize_style();
-
 #endif